@@ -1,160 +1,1100 @@
 #include "Analyser.hpp"
+#include "FileReader.hpp"
+#include "IncludeResolver.hpp"
+#include "IncludeScanner.hpp"
+#include "SocketServer.hpp"
+#include "ThreadPool.hpp"
+#include "Watcher.hpp"
 #include "Utils.hpp"
 #include <stdexcept>
 #include <iostream>
-#include <fstream>
-#include <regex>
-#include <set>
+#include <functional>
+#include <mutex>
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <unordered_map>
 
 #pragma region Static
-std::vector<tdw::Analyser::Include> tdw::Analyser::getIncludes(const path_type& _path) {
-    std::ifstream ifs;
-    // Makes the `ifstream` throw an exception in case it fails to open the file
-    ifs.exceptions(ifs.exceptions() | std::ios::failbit);
-    ifs.open(_path);
-    using if_stream_buf_it = typename std::istreambuf_iterator<std::ifstream::char_type>;
-    const std::string fileData{ {if_stream_buf_it{ifs}}, if_stream_buf_it{} };
-    ifs.close();
-
-    // https://regex101.com/r/8IegEz/2
-    const std::regex noiseRegex{ R"reg(((?:(?:R"(.*)\()(?:[\s\S\n]*?)(?:\)\2")|(?:R"(.*)\()(?:[\s\S\n]*))|(?:(?:\/\*)(?:[\s\S\n]*?)(?:\*\/)|(?:\/\*)(?:[\s\S\n]*))))reg" };
-    const auto filteredFileData = std::regex_replace(fileData, noiseRegex, "");
-
-    // https://regex101.com/r/sd5Gpb/1
-    const std::regex includeRegex{ R"reg((?:^|\n)[^\S\r\n]*#[^\S\r\n]*include[^\S\r\n]*("([\w.\/\\]+(\.hpp|\.cpp))"|\<([\w.\/\\]+(\.hpp|\.cpp))\>))reg" };
-    constexpr auto quoteMatchIndex = static_cast<std::smatch::size_type>(2);
-    constexpr auto bracketMatchIndex = static_cast<std::smatch::size_type>(4);
+std::vector<tdw::Include> tdw::Analyser::getIncludes(const path_type& _path, const BuildOptions& _options, bool& _guarded) {
+    // Each thread reuses its buffer for all the files it reads
+    thread_local FileReader reader;
+    const auto statistics = _options.statistics;
+    const auto cache = _options.cache;
+
+    std::optional<Statistics::Timer> timer{ std::in_place, statistics, Statistics::Phase::read };
+    std::optional<ScanCache::FileStamp> stamp;
+    std::optional<ScanCache::Record> record;
+    if(cache) {
+        stamp = ScanCache::stamp(_path);
+        record = cache->find(_path);
+        if(record && record->stamp == *stamp) {
+            auto includes = record->includes;
+            _guarded = record->guarded;
+            cache->store(_path, std::move(*record));
+            Statistics::add(statistics, Statistics::Counter::scanCacheHits);
+            return includes;
+        }
+    }
+
+    const auto fileData = reader.read(_path);
+    Statistics::add(statistics, Statistics::Counter::bytesRead, fileData.size());
+    // The content may still be the same (e.g. the file was touched), then the scan can be skipped
+    const auto hash = cache ? ScanCache::hash(fileData) : 0;
+    timer.reset();
 
     std::vector<Include> includes;
-    for(std::sregex_iterator it{ filteredFileData.cbegin(), filteredFileData.end(), includeRegex }; it != std::sregex_iterator{}; ++it) {
-        const auto& match = *it;
+    if(record && record->hash == hash) {
+        includes = std::move(record->includes);
+        _guarded = record->guarded;
+        Statistics::add(statistics, Statistics::Counter::scanCacheHits);
+    } else {
+        timer.emplace(statistics, Statistics::Phase::scan);
+        IncludeScanner scanner{ fileData, _options.preambleOnly, _options.macros };
+        includes = scanner.scan();
+        _guarded = scanner.guarded();
+        Statistics::add(statistics, Statistics::Counter::filesParsed);
+    }
+    if(cache) {
+        cache->store(_path, ScanCache::Record{ *stamp, hash, _guarded, includes });
+    }
+    return includes;
+}
+
+void tdw::Analyser::printDependencyTree(const IncludeGraph& _graph,
+                                       const edge_records_type& _edgeRecords,
+                                       std::string_view _record,
+                                       IncludeGraph::node_id_type _node,
+                                       include_counter_type& _includeCounter,
+                                       include_chain_type& _includeChain,
+                                       include_chain_type& _expandedFiles,
+                                       include_chain_type& _unitFiles,
+                                       const TreeOptions& _treeOptions,
+                                       OutputWriter& _output,
+                                       unsigned _depth) {
+    constexpr auto depthStep = static_cast<decltype(_depth)>(2);
+
+    const auto found = _graph.files().found(_node);
+    const auto cycleInclude = static_cast<bool>(_includeChain[_node]);
+    const auto& edges = _graph.node(_node).edges;
+    // The guard makes the repeated include of the file within the same source file empty
+    const auto repeated = found && !cycleInclude && _graph.node(_node).guarded && _unitFiles[_node];
+    const auto expandable = found && !cycleInclude && !repeated && !edges.empty();
+    // A file is marked once it's printed the second time or at the last level, if it includes anything
+    const auto collapsed = expandable && _treeOptions.collapseRepeated && _expandedFiles[_node];
+    const auto truncated = expandable && !collapsed && _depth / depthStep >= _treeOptions.maxDepth;
+    if(_depth) {
+        _output.write('_', _depth); // Underscorde instead of dot for the better distinctions with special paths ("." and "..")
+    }
+    _output.write(_record);
+    if(!found) {
+        _output.write("(!)");
+    }
+    if(cycleInclude) {
+        _output.write("(~)");
+    }
+    if(repeated) {
+        _output.write("(=)");
+    }
+    if(collapsed) {
+        _output.write("(*)");
+    }
+    if(truncated) {
+        _output.write("(+)");
+    }
+    _output.write('\n');
+
+    if(!found || cycleInclude || repeated || collapsed || truncated) {
+        return;
+    }
+
+    // The chain is shared by all the branches, each branch unmarks its own file once it's done
+    _includeChain[_node] = true;
+    _expandedFiles[_node] = true;
+    _unitFiles[_node] = true;
+    for(std::size_t i = 0; i < edges.size(); ++i) {
+        printDependencyTree(_graph, _edgeRecords, _edgeRecords[_node][i], edges[i].target, _includeCounter, _includeChain, _expandedFiles, _unitFiles,
+                            _treeOptions, _output, _depth + depthStep);
+        // Cycle includes still count, but nothing after it (because it gets printed and needs to be consistent)
+        _includeCounter[edges[i].target]++;
+    }
+    _includeChain[_node] = false;
+}
+
+tdw::Analyser::edge_records_type tdw::Analyser::makeEdgeRecords(const IncludeGraph& _graph) {
+    edge_records_type edgeRecords(_graph.size());
+    for(IncludeGraph::node_id_type node = 0; node < _graph.size(); ++node) {
+        for(const auto& edge : _graph.node(node).edges) {
+            // avoid using "make_preferred()", to keep the output consistent with include directive
+            const auto spelling = edge.spellingPath();
+            auto& record = edgeRecords[node].emplace_back();
+            OutputWriter::appendQuoted(record, (spelling.is_relative() ? spelling : std::filesystem::relative(spelling, edge.parentDirectory())).string());
+        }
+    }
+
+    return edgeRecords;
+}
+
+tdw::Analyser::include_counter_type tdw::Analyser::countIncludes(const IncludeGraph& _graph, const std::vector<IncludeGraph::node_id_type>& _roots) {
+    const auto components = _graph.components();
+    std::vector<std::size_t> component(_graph.size());
+    for(std::size_t i = 0; i < components.size(); ++i) {
+        for(const auto node : components[i]) {
+            component[node] = i;
+        }
+    }
+
+    include_counter_type includeCounter(_graph.size());
+    include_counter_type entryCounter(_graph.size());
+    include_chain_type includeChain(_graph.size());
+    // Within the source files, which include a guarded file more than once, the chains are followed one by one, since the repeated
+    // includes are not followed. The rest of the source files and the files, which lead to no guarded file, are counted in bulk
+    const auto guardedReach = reachGuardedFiles(_graph, components);
+    include_chain_type unitFiles(_graph.size());
+    std::vector<IncludeGraph::node_id_type> touchedNodes;
+    for(const auto root : _roots) {
+        if(guardedReach.empty() || !repeatsGuardedFile(_graph, root, guardedReach, unitFiles, touchedNodes)) {
+            entryCounter[root]++;
+            continue;
+        }
+        countUnitIncludes(_graph, root, guardedReach, includeCounter, entryCounter, includeChain, unitFiles);
+        unitFiles.assign(_graph.size(), false);
+    }
 
-        if(match.size() <= std::max(quoteMatchIndex, bracketMatchIndex)) {
+    // Every chain entering a component comes from the components before it, so its entries are final once it's reached. Each
+    // chain entering a cycle follows every include of the cycle once, so the members pass all of the entries on
+    for(const auto& members : components) {
+        include_counter_type::value_type chainsCount = 0;
+        for(const auto member : members) {
+            chainsCount += entryCounter[member];
+        }
+        if(!chainsCount) {
             continue;
         }
 
-        if(match[quoteMatchIndex].matched) {
-            includes.emplace_back(match.str(quoteMatchIndex), Include::Type::q_char);
-        } else if(match[bracketMatchIndex].matched) {
-            includes.emplace_back(match.str(bracketMatchIndex), Include::Type::h_char);
+        for(const auto member : members) {
+            if(!_graph.files().found(member)) {
+                continue;
+            }
+            for(const auto& edge : _graph.node(member).edges) {
+                includeCounter[edge.target] += chainsCount;
+                if(component[edge.target] != component[member]) {
+                    entryCounter[edge.target] += chainsCount;
+                }
+            }
         }
     }
 
-    return includes;
+    return includeCounter;
 }
 
-tdw::Analyser::path_type tdw::Analyser::printDependencyTree(const Include& _sourceFile,
-                                        const path_type _currentPath,
-                                        const std::vector<path_type>& _includePaths,
-                                        include_counter_map_type& _includeCounter,
-                                        include_chain_set_type& _includeChain,
-                                        unsigned _depth) {
-    constexpr auto depthStep = static_cast<decltype(_depth)>(2);
-    using namespace std::filesystem;
+tdw::Analyser::include_chain_type tdw::Analyser::reachGuardedFiles(const IncludeGraph& _graph, const std::vector<std::vector<IncludeGraph::node_id_type>>& _components) {
+    include_chain_type guardedReach(_graph.size());
+    auto guardedFiles = false;
+    // The components after a component are done before it, and the members of a component reach the same files
+    for(auto members = _components.crbegin(); members != _components.crend(); ++members) {
+        auto reach = false;
+        for(const auto member : *members) {
+            if(!_graph.files().found(member)) {
+                continue;
+            }
+            reach = reach || _graph.node(member).guarded;
+            for(const auto& edge : _graph.node(member).edges) {
+                reach = reach || guardedReach[edge.target];
+            }
+        }
+        for(const auto member : *members) {
+            guardedReach[member] = reach;
+        }
+        guardedFiles = guardedFiles || reach;
+    }
 
-    const auto parentPath = findIncludeParentPath(_sourceFile, _currentPath, _includePaths);
-    const auto cycleInclude = !_includeChain.insert(std::make_pair(_sourceFile.path, parentPath)).second;
-    if(_sourceFile.path.is_relative()) {
-        printIncludeBranchRecord(_sourceFile.path, _depth, !parentPath.empty(), cycleInclude);
-    } else {
-        printIncludeBranchRecord(_sourceFile.path, _depth, !parentPath.empty(), cycleInclude, parentPath);
+    return guardedFiles ? guardedReach : include_chain_type{};
+}
+
+bool tdw::Analyser::repeatsGuardedFile(const IncludeGraph& _graph,
+                                       IncludeGraph::node_id_type _root,
+                                       const include_chain_type& _guardedReach,
+                                       include_chain_type& _visited,
+                                       std::vector<IncludeGraph::node_id_type>& _stack) {
+    if(!_guardedReach[_root]) {
+        return false;
+    }
+
+    // A file reached the second time is included through more than one chain, so is every file it leads to. The files, which
+    // lead to no guarded file, don't matter. `_stack` keeps the visited files, so the marks are cleared afterwards
+    auto repeated = false;
+    _visited[_root] = true;
+    _stack.assign(1, _root);
+    for(std::size_t i = 0; i < _stack.size() && !repeated; ++i) {
+        for(const auto& edge : _graph.node(_stack[i]).edges) {
+            if(!_guardedReach[edge.target]) {
+                continue;
+            } else if(_visited[edge.target]) {
+                repeated = true;
+                break;
+            }
+            _visited[edge.target] = true;
+            _stack.push_back(edge.target);
+        }
     }
 
-    if(!parentPath.empty() && !cycleInclude) {
-        const auto filePath = parentPath / _sourceFile.path;
+    for(const auto node : _stack) {
+        _visited[node] = false;
+    }
+    return repeated;
+}
+
+void tdw::Analyser::countUnitIncludes(const IncludeGraph& _graph,
+                                      IncludeGraph::node_id_type _node,
+                                      const include_chain_type& _guardedReach,
+                                      include_counter_type& _includeCounter,
+                                      include_counter_type& _entryCounter,
+                                      include_chain_type& _includeChain,
+                                      include_chain_type& _unitFiles) {
+    _includeChain[_node] = true;
+    _unitFiles[_node] = true;
+    for(const auto& edge : _graph.node(_node).edges) {
+        _includeCounter[edge.target]++;
+        const auto repeated = _graph.node(edge.target).guarded && _unitFiles[edge.target];
+        if(!_graph.files().found(edge.target) || _includeChain[edge.target] || repeated) {
+            continue;
+        }
+        // Nothing is cut below such a file and it can't lead back into the chain, so the condensed pass counts it
+        if(!_guardedReach[edge.target]) {
+            _entryCounter[edge.target]++;
+            continue;
+        }
+        countUnitIncludes(_graph, edge.target, _guardedReach, _includeCounter, _entryCounter, _includeChain, _unitFiles);
+    }
+    _includeChain[_node] = false;
+}
+
+void tdw::Analyser::printIncludeCounters(const IncludeGraph& _graph,
+                                        const include_counter_type& _includeCounter,
+                                        std::vector<IncludeGraph::node_id_type> _nodes,
+                                        OutputWriter& _output) {
+    const auto& files = _graph.files();
+    const auto counterLess = [&_includeCounter, &files](IncludeGraph::node_id_type left, IncludeGraph::node_id_type right) {
+        if(_includeCounter[left] != _includeCounter[right]) {
+            return _includeCounter[left] > _includeCounter[right];
+        } else if(files.displayPath(left) != files.displayPath(right)) {
+            return files.displayPath(left) < files.displayPath(right);
+        } else {
+            return files.path(left) < files.path(right);
+        }
+    };
+    std::sort(_nodes.begin(), _nodes.end(), counterLess);
+
+    for(const auto node : _nodes) {
+        _output.writeQuoted(files.displayPath(node).string());
+        _output.write(' ');
+        _output.write(_includeCounter[node]);
+        _output.write('\n');
+    }
+}
 
+void tdw::Analyser::scanFiles(IncludeGraph& _graph, IncludeResolver& _resolver, const std::vector<IncludeGraph::node_id_type>& _nodes, const BuildOptions& _options) {
+    // Guards the graph, while the files are being read
+    std::mutex graphMutex;
+    ThreadPool pool{ _options.jobs };
+
+    // Files are read and their includes are resolved concurrently, only linking the results into the graph is serialized
+    std::function<void(IncludeGraph::node_id_type)> readFile = [&](IncludeGraph::node_id_type _node) {
+        path_type filePath;
+        IncludeResolver::context_type context;
+        {
+            std::lock_guard lock{ graphMutex };
+            filePath = _graph.files().path(_node);
+            context = _graph.files().context(_node);
+        }
         // For each file the search should happen relative to the directory it is in
         const auto directoryPath = filePath.parent_path();
-        const auto includes = getIncludes(filePath);
-        for(const auto& include : includes) {
-            auto subIncludeChain{ _includeChain }; // each include branch needs to track it's chain independently
-            const auto includeParentPath = printDependencyTree(
-                include, directoryPath, _includePaths, _includeCounter, subIncludeChain, _depth + depthStep);
-            // Cycle includes still count, but nothing after it (because it gets printed and needs to be consistent)
-            const auto counterKey = std::make_pair(include.path, includeParentPath);
-            _includeCounter[counterKey]++;
+
+        const auto parseStart = std::chrono::steady_clock::now();
+        auto guarded = false;
+        const auto includes = getIncludes(filePath, _options, guarded);
+        Statistics::addParseTime(_options.statistics, filePath.string(), std::chrono::duration<double>(std::chrono::steady_clock::now() - parseStart).count());
+        Statistics::add(_options.statistics, Statistics::Counter::directivesFound, includes.size());
+
+        std::vector<const IncludeResolver::Resolution*> resolutions;
+        resolutions.reserve(includes.size());
+        {
+            Statistics::Timer timer{ _options.statistics, Statistics::Phase::resolve };
+            for(const auto& include : includes) {
+                resolutions.push_back(&_resolver.resolve(include, directoryPath, context));
+            }
+        }
+
+        std::vector<IncludeGraph::node_id_type> newNodes;
+        {
+            // Includes the time spent waiting for the lock
+            Statistics::Timer timer{ _options.statistics, Statistics::Phase::link };
+            std::lock_guard lock{ graphMutex };
+            _graph.node(_node).guarded = guarded;
+            newNodes = linkIncludes(_graph, _node, includes, resolutions);
+        }
+        Statistics::add(_options.statistics, Statistics::Counter::mapOperations, includes.size());
+
+        for(const auto node : newNodes) {
+            pool.submit([&readFile, node] { readFile(node); });
+        }
+    };
+
+    // Marked before any task starts, so the tasks don't race with the marking and don't submit the nodes again
+    for(const auto node : _nodes) {
+        _graph.node(node).scanned = true;
+    }
+    for(const auto node : _nodes) {
+        pool.submit([&readFile, node] { readFile(node); });
+    }
+    pool.wait();
+}
+
+void tdw::Analyser::relinkFiles(IncludeGraph& _graph, IncludeResolver& _resolver, const BuildOptions& _options) {
+    std::vector<IncludeGraph::node_id_type> newNodes;
+    for(IncludeGraph::node_id_type node = 0; node < _graph.size(); ++node) {
+        if(!_graph.node(node).scanned) {
+            continue;
         }
+
+        const auto directoryPath = _graph.files().path(node).parent_path();
+        const auto context = _graph.files().context(node);
+        std::vector<Include> includes;
+        std::vector<const IncludeResolver::Resolution*> resolutions;
+        for(const auto& edge : _graph.node(node).edges) {
+            includes.push_back(edge.include());
+            resolutions.push_back(&_resolver.resolve(includes.back(), directoryPath, context));
+        }
+
+        const auto nodes = linkIncludes(_graph, node, includes, resolutions);
+        newNodes.insert(newNodes.end(), nodes.cbegin(), nodes.cend());
     }
 
-    return parentPath;
+    scanFiles(_graph, _resolver, newNodes, _options);
 }
 
-tdw::Analyser::path_type tdw::Analyser::findIncludeParentPath(const Include& _sourceFile, const path_type _currentPath, const std::vector<path_type>& _includePaths) {
-    using namespace std::filesystem;
+std::vector<tdw::IncludeGraph::node_id_type> tdw::Analyser::linkIncludes(IncludeGraph& _graph,
+                                                                         IncludeGraph::node_id_type _node,
+                                                                         const std::vector<Include>& _includes,
+                                                                         const std::vector<const IncludeResolver::Resolution*>& _resolutions) {
+    std::vector<IncludeGraph::Edge> edges;
+    edges.reserve(_includes.size());
+    std::vector<IncludeGraph::node_id_type> newNodes;
+    for(std::size_t i = 0; i < _includes.size(); ++i) {
+        const auto& resolution = *_resolutions[i];
+        const auto spelling = _graph.strings().intern(_includes[i].path.native());
+        const auto parentPath = _graph.strings().intern(resolution.parentPath.native());
+        if(resolution.parentPath.empty()) {
+            edges.push_back(IncludeGraph::Edge{ spelling, _includes[i].type, parentPath, _graph.addMissingNode(_includes[i].path).first });
+            continue;
+        }
+
+        // The included file is resolved within the same context its includes are
+        const auto includeNode = _graph.addCanonicalNode(resolution.filePath, _graph.files().context(_node)).first;
+        if(!_graph.node(includeNode).scanned) {
+            _graph.node(includeNode).scanned = true;
+            newNodes.push_back(includeNode);
+        }
+        edges.push_back(IncludeGraph::Edge{ spelling, _includes[i].type, parentPath, includeNode });
+    }
+    _graph.node(_node).edges = std::move(edges);
+
+    return newNodes;
+}
+
+void tdw::Analyser::assignDisplayPaths(IncludeGraph& _graph, const std::vector<IncludeGraph::node_id_type>& _roots) {
+    // Display paths are assigned in a separate pass, so they don't depend on the order the files were read in
+    std::vector<bool> visited(_graph.size());
+    std::vector<std::pair<IncludeGraph::node_id_type, std::size_t>> stack;
+    for(const auto root : _roots) {
+        if(visited[root]) {
+            continue;
+        }
+        visited[root] = true;
+        stack.emplace_back(root, 0);
 
-    // Follows C standard "6.10.2 Source file inclusion" - http://www.open-std.org/jtc1/sc22/wg14/www/docs/n1570.pdf#page=182
-    if(_sourceFile.type == Include::Type::q_char) {
-        const auto searchPath = _currentPath / _sourceFile.path;
+        while(!stack.empty()) {
+            auto& [node, edgeIndex] = stack.back();
+            const auto& edges = _graph.node(node).edges;
+            if(edgeIndex == edges.size()) {
+                stack.pop_back();
+                continue;
+            }
 
-        if(is_regular_file(searchPath)) {
-            return _currentPath;
+            const auto& edge = edges[edgeIndex++];
+            if(visited[edge.target]) {
+                continue;
+            }
+            visited[edge.target] = true;
+            if(_graph.files().displayPath(edge.target).empty()) {
+                _graph.files().setDisplayPath(edge.target, edge.spellingPath());
+            }
+            stack.emplace_back(edge.target, 0);
         }
     }
+}
 
-    for(const auto& includePath : _includePaths) {
-        const auto searchPath = includePath / _sourceFile.path;
-        if(is_regular_file(searchPath)) {
-            return includePath;
+void tdw::Analyser::printIncluders(const IncludeGraph& _graph, const ReverseIndex& _index, const path_type& _file, OutputWriter& _output) {
+    auto includers = ReverseIndex::Search{ _index }.includers(findNodes(_graph, _file));
+    const auto& files = _graph.files();
+    if(files.contextsCount() > 1) {
+        // The copies of an includer made within the other contexts are reported once, at the shortest distance
+        for(auto& includer : includers) {
+            includer.node = files.primary(includer.node);
         }
+        std::sort(includers.begin(), includers.end(), [](const ReverseIndex::Reached& _left, const ReverseIndex::Reached& _right) {
+            return _left.node != _right.node ? _left.node < _right.node : _left.distance < _right.distance;
+        });
+        includers.erase(std::unique(includers.begin(), includers.end(), [](const ReverseIndex::Reached& _left, const ReverseIndex::Reached& _right) {
+            return _left.node == _right.node;
+        }), includers.end());
     }
+    std::sort(includers.begin(), includers.end(), [&files](const ReverseIndex::Reached& _left, const ReverseIndex::Reached& _right) {
+        if(_left.distance != _right.distance) {
+            return _left.distance < _right.distance;
+        } else if(files.displayPath(_left.node) != files.displayPath(_right.node)) {
+            return files.displayPath(_left.node) < files.displayPath(_right.node);
+        } else {
+            return files.path(_left.node) < files.path(_right.node);
+        }
+    });
 
-    return path_type();
+    for(const auto& includer : includers) {
+        _output.writeQuoted(files.displayPath(includer.node).string());
+        _output.write(' ');
+        _output.write(static_cast<std::uint64_t>(includer.distance));
+        _output.write('\n');
+    }
 }
 
+void tdw::Analyser::printImpact(const IncludeGraph& _graph,
+                               const ReverseIndex& _index,
+                               const std::vector<IncludeGraph::node_id_type>& _roots,
+                               unsigned _jobs,
+                               OutputWriter& _output) {
+    const auto& files = _graph.files();
+
+    std::vector<std::uint64_t> fileSizes(_graph.size());
+    for(IncludeGraph::node_id_type node = 0; node < _graph.size(); ++node) {
+        std::error_code errorCode;
+        const auto fileSize = files.found(node) ? std::filesystem::file_size(files.path(node), errorCode) : 0;
+        fileSizes[node] = errorCode ? 0 : static_cast<std::uint64_t>(fileSize);
+    }
+
+    std::vector<IncludeGraph::node_id_type> units;
+    for(const auto root : _roots) {
+        if(isTranslationUnit(files.path(root))) {
+            units.push_back(root);
+        }
+    }
+
+    // A file rebuilds the units reaching it, so instead of searching for the includers of every file, the files each unit pulls
+    // in are searched for (there are fewer units than files). Units are searched in parallel, a range of them per task, and
+    // each task sums its units up on its own
+    std::vector<std::uint64_t> unitsReached(_graph.size());
+    std::vector<std::uint64_t> bytesReached(_graph.size());
+    std::mutex resultMutex;
+    ThreadPool pool{ _jobs };
+    const auto rangeSize = std::max<std::size_t>(1, units.size() / (static_cast<std::size_t>(_jobs) * 8));
+    for(std::size_t begin = 0; begin < units.size(); begin += rangeSize) {
+        pool.submit([&, begin] {
+            ReverseIndex::Search search{ _index };
+            std::vector<std::uint64_t> rangeUnits(_graph.size());
+            std::vector<std::uint64_t> rangeBytes(_graph.size());
+            for(auto i = begin; i < std::min(units.size(), begin + rangeSize); ++i) {
+                const auto& included = search.includes({ units[i] });
+                auto unitSize = fileSizes[units[i]];
+                for(const auto& file : included) {
+                    unitSize += fileSizes[file.node];
+                }
+                for(const auto& file : included) {
+                    ++rangeUnits[file.node];
+                    rangeBytes[file.node] += unitSize;
+                }
+            }
+
+            std::lock_guard lock{ resultMutex };
+            for(IncludeGraph::node_id_type node = 0; node < _graph.size(); ++node) {
+                unitsReached[node] += rangeUnits[node];
+                bytesReached[node] += rangeBytes[node];
+            }
+        });
+    }
+    pool.wait();
+    // Each unit reaches the copy of the file made within its own context, so the copies add up
+    mergeContexts(_graph, unitsReached);
+    mergeContexts(_graph, bytesReached);
+
+    struct Impact {
+        IncludeGraph::node_id_type node;
+        std::uint64_t units;
+        std::uint64_t bytes;
+    };
+    std::vector<bool> translationUnits(_graph.size());
+    for(const auto unit : units) {
+        translationUnits[files.primary(unit)] = true;
+    }
+    std::vector<Impact> impacts;
+    for(const auto node : primaryNodes(_graph)) {
+        // Neither the missing files, nor the translation units themselves rebuild anything else
+        if(files.found(node) && !translationUnits[node]) {
+            impacts.push_back(Impact{ node, unitsReached[node], bytesReached[node] });
+        }
+    }
+
+    std::sort(impacts.begin(), impacts.end(), [&files](const Impact& _left, const Impact& _right) {
+        if(_left.bytes != _right.bytes) {
+            return _left.bytes > _right.bytes;
+        } else if(_left.units != _right.units) {
+            return _left.units > _right.units;
+        } else if(files.displayPath(_left.node) != files.displayPath(_right.node)) {
+            return files.displayPath(_left.node) < files.displayPath(_right.node);
+        } else {
+            return files.path(_left.node) < files.path(_right.node);
+        }
+    });
+
+    for(const auto& impact : impacts) {
+        _output.writeQuoted(files.displayPath(impact.node).string());
+        _output.write(' ');
+        _output.write(impact.units);
+        _output.write(' ');
+        _output.write(impact.bytes);
+        _output.write('\n');
+    }
+}
+
+void tdw::Analyser::printCycles(const IncludeGraph& _graph, OutputWriter& _output) {
+    const auto& files = _graph.files();
+    const auto pathLess = [&files](IncludeGraph::node_id_type _left, IncludeGraph::node_id_type _right) {
+        if(files.displayPath(_left) != files.displayPath(_right)) {
+            return files.displayPath(_left) < files.displayPath(_right);
+        }
+        return files.path(_left) < files.path(_right);
+    };
+
+    std::vector<std::vector<IncludeGraph::node_id_type>> cycles;
+    for(auto& component : _graph.components()) {
+        const auto& edges = _graph.node(component.front()).edges;
+        const auto includesItself = std::any_of(edges.cbegin(), edges.cend(), [&component](const IncludeGraph::Edge& _edge) {
+            return _edge.target == component.front();
+        });
+        if(component.size() > 1 || includesItself) {
+            // The same cycle made within several contexts is reported once
+            for(auto& node : component) {
+                node = files.primary(node);
+            }
+            std::sort(component.begin(), component.end(), pathLess);
+            cycles.push_back(std::move(component));
+        }
+    }
+    std::sort(cycles.begin(), cycles.end(), [&pathLess](const auto& _left, const auto& _right) {
+        return std::lexicographical_compare(_left.cbegin(), _left.cend(), _right.cbegin(), _right.cend(), pathLess);
+    });
+    cycles.erase(std::unique(cycles.begin(), cycles.end()), cycles.end());
+
+    for(const auto& cycle : cycles) {
+        for(std::size_t i = 0; i < cycle.size(); ++i) {
+            if(i) {
+                _output.write(' ');
+            }
+            _output.writeQuoted(files.displayPath(cycle[i]).string());
+        }
+        _output.write('\n');
+    }
+}
 #pragma endregion
 
 #pragma region Lifecycle
-tdw::Analyser::Analyser(const path_type& _path) : path{ std::filesystem::canonical(_path) } {
-    using namespace std::filesystem;
-    using utils::operator==;
+tdw::Analyser::Analyser(const path_type& _path, Statistics* _statistics) : Analyser{ _path, SourceOptions{}, _statistics } {}
 
+tdw::Analyser::Analyser(const path_type& _path, const SourceOptions& _options, Statistics* _statistics)
+    : path{ std::filesystem::canonical(_path) }, sourceFilter{ _options.filter } {
     utils::directoryArgumentAssert(_path);
+    Statistics::Timer timer{ _statistics, Statistics::Phase::walk };
 
     source_files_type tmp;
-    for(const auto& entry : recursive_directory_iterator(path)) {
-        // Copies the reference value (`.extension()` returns a temporary, while `native()` returns a reference to the content of it)
-        const auto extension = path_type::string_type(entry.path().extension().native());
-        const auto comparisonResult = (".hpp" == extension) || (".cpp" == extension);
-        if(!entry.is_regular_file() || !comparisonResult) {
-            // Ignore folders, irregular and irrelevant files
+    for(auto& filePath : DirectoryWalker{ sourceFilter, _options.jobs }.walk(path)) {
+        tmp.emplace(std::move(filePath), Include::Type::q_char);
+    }
+    sourceFiles = std::move(tmp);
+}
+
+tdw::Analyser::Analyser(const path_type& _path, const CompilationDatabase& _database, const SourceOptions& _options, Statistics* _statistics)
+    : path{ std::filesystem::canonical(_path) },
+      sourceFilter{ {}, _options.filter.ignored, _options.filter.included },
+      databaseSourceFiles{ true },
+      sourceSearchPaths{ _database.searchPaths() } {
+    using namespace std::filesystem;
+
+    utils::directoryArgumentAssert(_path);
+    Statistics::Timer timer{ _statistics, Statistics::Phase::walk };
+
+    for(const auto& entry : _database.entries()) {
+        // The generated files may not exist yet, the files outside of the directory are not analysed
+        std::error_code errorCode;
+        const auto filePath = weakly_canonical(entry.file, errorCode);
+        if(errorCode || !is_regular_file(filePath, errorCode) || !utils::isWithinDirectory(filePath, path) ||
+           !isSourceFile(filePath)) {
             continue;
         }
 
-        tmp.emplace(entry.path(), Include::Type::q_char);
+        // A file compiled several times is analysed with the include directories it's listed with first
+        if(sourceFiles.emplace(filePath, Include::Type::q_char).second) {
+            sourceSearchPathIndices.emplace(filePath.native(), entry.searchPathsIndex);
+        }
     }
-    sourceFiles = std::move(tmp);
 }
 #pragma endregion
 
 #pragma region Actions
-void tdw::Analyser::printDependencyTree(const std::vector<path_type>& _includePaths) const {
-    using namespace std::filesystem;
+bool tdw::Analyser::isSourceFile(const path_type& _path) const {
+    return sourceFilter.accepts(_path.lexically_relative(path));
+}
+
+bool tdw::Analyser::isTranslationUnit(const path_type& _path) {
+    using utils::operator==;
+
+    // Copies the reference value (`.extension()` returns a temporary, while `native()` returns a reference to the content of it)
+    const auto extension = path_type::string_type(_path.extension().native());
+    return (".cpp" == extension) || (".cc" == extension) || (".cxx" == extension) || (".c++" == extension) || (".c" == extension);
+}
+
+std::vector<tdw::IncludeGraph::node_id_type> tdw::Analyser::findNodes(const IncludeGraph& _graph, const path_type& _file) {
+    std::vector<IncludeGraph::node_id_type> nodes;
+    std::error_code errorCode;
+    if(std::filesystem::exists(_file, errorCode)) {
+        const auto filePath = std::filesystem::weakly_canonical(_file);
+        for(FileTable::context_type context = 0; context < _graph.files().contextsCount(); ++context) {
+            const auto node = _graph.files().find(filePath, context);
+            if(node != FileTable::invalid_file) {
+                nodes.push_back(node);
+            }
+        }
+    } else {
+        // The same spelling may refer to different files, each of them is considered
+        for(IncludeGraph::node_id_type node = 0; node < _graph.size(); ++node) {
+            if(_graph.files().displayPath(node) == _file) {
+                nodes.push_back(node);
+            }
+        }
+    }
+
+    if(nodes.empty()) {
+        throw std::invalid_argument{ "The file is not included anywhere: \"" + _file.string() + "\"" };
+    }
+    return nodes;
+}
+
+std::vector<tdw::IncludeGraph::node_id_type> tdw::Analyser::primaryNodes(const IncludeGraph& _graph) {
+    std::vector<IncludeGraph::node_id_type> nodes;
+    nodes.reserve(_graph.size());
+    for(IncludeGraph::node_id_type node = 0; node < _graph.size(); ++node) {
+        if(_graph.files().primary(node) == node) {
+            nodes.push_back(node);
+        }
+    }
+
+    return nodes;
+}
 
-    include_counter_map_type includesCounter;
+void tdw::Analyser::mergeContexts(const IncludeGraph& _graph, include_counter_type& _counter) {
+    if(_graph.files().contextsCount() <= 1) {
+        return;
+    }
+
+    for(IncludeGraph::node_id_type node = 0; node < _graph.size(); ++node) {
+        const auto primary = _graph.files().primary(node);
+        if(primary != node) {
+            _counter[primary] += _counter[node];
+            _counter[node] = 0;
+        }
+    }
+}
+
+std::vector<tdw::IncludeResolver::context_type> tdw::Analyser::addSearchContexts(IncludeResolver& _resolver, const std::vector<path_type>& _includePaths) const {
+    std::vector<IncludeResolver::context_type> contexts;
+    contexts.reserve(sourceSearchPaths.size());
+    for(const auto& searchPaths : sourceSearchPaths) {
+        auto contextPaths = searchPaths;
+        contextPaths.includePaths.insert(contextPaths.includePaths.end(), _includePaths.cbegin(), _includePaths.cend());
+        contexts.push_back(_resolver.addContext(std::move(contextPaths)));
+    }
+
+    return contexts;
+}
+
+std::vector<tdw::IncludeGraph::node_id_type> tdw::Analyser::addSourceFiles(IncludeGraph& _graph,
+                                                                           const source_files_type& _sourceFiles,
+                                                                           const std::vector<IncludeResolver::context_type>& _contexts) const {
+    std::vector<IncludeGraph::node_id_type> roots;
+    roots.reserve(_sourceFiles.size());
+    for(const auto& sourceFile : _sourceFiles) {
+        // The files not listed by the compilation database are resolved within the default context
+        const auto index = sourceSearchPathIndices.find(sourceFile.path.native());
+        const auto context = index == sourceSearchPathIndices.cend() ? 0 : _contexts[index->second];
+        const auto node = _graph.addNode(sourceFile.path, context).first;
+        _graph.files().setDisplayPath(node, std::filesystem::relative(sourceFile.path, path));
+        roots.push_back(node);
+    }
+
+    return roots;
+}
+
+std::pair<tdw::IncludeGraph, std::vector<tdw::IncludeGraph::node_id_type>> tdw::Analyser::buildIncludeGraph(const std::vector<path_type>& _includePaths, const BuildOptions& _options) const {
+    Statistics::Timer timer{ _options.statistics, Statistics::Phase::build };
+    IncludeGraph graph;
+    IncludeResolver resolver{ _includePaths };
+    const auto roots = addSourceFiles(graph, sourceFiles, addSearchContexts(resolver, _includePaths));
+    Statistics::add(_options.statistics, Statistics::Counter::mapOperations, roots.size());
+
+    scanFiles(graph, resolver, roots, _options);
+    assignDisplayPaths(graph, roots);
+
+    const auto resolverStatistics = resolver.statistics();
+    Statistics::add(_options.statistics, Statistics::Counter::resolverLookups, resolverStatistics.lookupHits + resolverStatistics.lookupMisses);
+    Statistics::add(_options.statistics, Statistics::Counter::resolverCacheHits, resolverStatistics.lookupHits);
+    Statistics::add(_options.statistics, Statistics::Counter::resolverProbes, resolverStatistics.probes);
+    Statistics::add(_options.statistics, Statistics::Counter::directoryListings, resolverStatistics.directoryListings);
+    Statistics::add(_options.statistics, Statistics::Counter::canonicalizations, resolverStatistics.canonicalizations);
 
-    for(const auto& sourceFile : sourceFiles) {
-        const auto counterKey = std::make_pair(relative(sourceFile.path, path), path);
-        includesCounter[counterKey] += 0; // initializes counter for the source in case it doesn't exist
-        include_chain_set_type includeChain;
-        printDependencyTree(sourceFile, path, _includePaths, includesCounter, includeChain);
+    return std::make_pair(std::move(graph), std::move(roots));
+}
+
+void tdw::Analyser::printDependencyTree(const IncludeGraph& _graph,
+                                       const std::vector<IncludeGraph::node_id_type>& _roots,
+                                       const source_files_type& _sourceFiles,
+                                       const TreeOptions& _treeOptions,
+                                       OutputWriter& _output) const {
+    const auto edgeRecords = makeEdgeRecords(_graph);
+    // Source files, which are not included anywhere, still get zero counter
+    include_counter_type includesCounter(_graph.size());
+    include_chain_type includeChain(_graph.size());
+    include_chain_type expandedFiles(_graph.size());
+    include_chain_type unitFiles;
+
+    auto root = _roots.cbegin();
+    std::string record;
+    for(const auto& sourceFile : _sourceFiles) {
+        record.clear();
+        OutputWriter::appendQuoted(record, std::filesystem::relative(sourceFile.path, path).string());
+        unitFiles.assign(_graph.size(), false);
+        printDependencyTree(_graph, edgeRecords, record, *root++, includesCounter, includeChain, expandedFiles, unitFiles, _treeOptions, _output);
+    }
+
+    _output.write('\n');
+
+    if(_treeOptions.collapseRepeated || _treeOptions.maxDepth != std::numeric_limits<unsigned>::max()) {
+        // The chains missing from the limited tree are counted as well
+        includesCounter = countIncludes(_graph, _roots);
     }
+    mergeContexts(_graph, includesCounter);
+    printIncludeCounters(_graph, includesCounter, primaryNodes(_graph), _output);
+}
+
+void tdw::Analyser::printDependencyTree(const std::vector<path_type>& _includePaths,
+                                        const BuildOptions& _options,
+                                        const TreeOptions& _treeOptions,
+                                        OutputWriter& _output) const {
+    const auto [graph, roots] = buildIncludeGraph(_includePaths, _options);
+    Statistics::Timer timer{ _options.statistics, Statistics::Phase::output };
+    printDependencyTree(graph, roots, sourceFiles, _treeOptions, _output);
+}
+
+void tdw::Analyser::printDependencyTree(const IncludeGraph& _graph, const std::vector<IncludeGraph::node_id_type>& _roots, OutputWriter& _output) const {
+    printDependencyTree(_graph, _roots, sourceFiles, TreeOptions{}, _output);
+}
+
+void tdw::Analyser::printIncludeCounters(const std::vector<path_type>& _includePaths, const BuildOptions& _options, OutputWriter& _output) const {
+    const auto [graph, roots] = buildIncludeGraph(_includePaths, _options);
+    Statistics::Timer timer{ _options.statistics, Statistics::Phase::output };
+
+    auto includeCounter = countIncludes(graph, roots);
+    mergeContexts(graph, includeCounter);
+    printIncludeCounters(graph, includeCounter, primaryNodes(graph), _output);
+}
+
+void tdw::Analyser::printIncluders(const std::vector<path_type>& _includePaths, const BuildOptions& _options, const path_type& _file, OutputWriter& _output) const {
+    const auto [graph, roots] = buildIncludeGraph(_includePaths, _options);
+    Statistics::Timer timer{ _options.statistics, Statistics::Phase::output };
+    printIncluders(graph, ReverseIndex{ graph }, _file, _output);
+}
 
-    std::cout << std::endl;
-    
-    const auto counterLess = [&includesCounter](const include_counter_map_type::value_type& left, const include_counter_map_type::value_type& right) {
-        if(left.second == right.second) {
-            return includesCounter.key_comp()(left.first, right.first);
+void tdw::Analyser::printImpact(const std::vector<path_type>& _includePaths, const BuildOptions& _options, OutputWriter& _output) const {
+    const auto [graph, roots] = buildIncludeGraph(_includePaths, _options);
+    Statistics::Timer timer{ _options.statistics, Statistics::Phase::output };
+    printImpact(graph, ReverseIndex{ graph }, roots, _options.jobs, _output);
+}
+
+void tdw::Analyser::exportGraph(const std::vector<path_type>& _includePaths, const BuildOptions& _options, GraphExporter::Format _format, OutputWriter& _output) const {
+    const auto [graph, roots] = buildIncludeGraph(_includePaths, _options);
+    Statistics::Timer timer{ _options.statistics, Statistics::Phase::output };
+    GraphExporter{ graph, roots }.write(_format, _output);
+}
+#pragma endregion
+
+#pragma region Watch
+void tdw::Analyser::loadLiveGraph(LiveGraph& _live, Watcher& _watcher, const std::vector<path_type>& _includePaths, const BuildOptions& _options) const {
+    _watcher.addDirectory(path, true);
+    for(const auto& includePath : _includePaths) {
+        _watcher.addDirectory(includePath, true);
+    }
+
+    _live.sourceFiles = sourceFiles;
+    _live.contexts = addSearchContexts(_live.resolver, _includePaths);
+    _live.roots = addSourceFiles(_live.graph, _live.sourceFiles, _live.contexts);
+    scanFiles(_live.graph, _live.resolver, _live.roots, _options);
+    assignDisplayPaths(_live.graph, _live.roots);
+    if(_options.cache) {
+        _options.cache->save();
+    }
+    watchFileDirectories(_live.graph, _watcher);
+}
+
+void tdw::Analyser::updateLiveGraph(LiveGraph& _live, Watcher& _watcher, const std::vector<Watcher::Event>& _events, const BuildOptions& _options) const {
+    using namespace std::filesystem;
+
+    auto& graph = _live.graph;
+    auto filesMoved = false;
+    std::unordered_set<path_type::string_type> changedFiles;
+    const auto updateSourceFile = [this, &changedFiles, &_live](const path_type& _filePath) {
+        const auto filePath = weakly_canonical(_filePath);
+        changedFiles.insert(filePath.native());
+        if(!utils::isWithinDirectory(filePath, path) || !isSourceFile(filePath)) {
+            return;
+        }
+        // Only the files listed by the compilation database are the source files then
+        if(databaseSourceFiles && !sourceSearchPathIndices.count(filePath.native())) {
+            return;
+        }
+
+        std::error_code errorCode;
+        if(is_regular_file(filePath, errorCode)) {
+            _live.sourceFiles.emplace(filePath, Include::Type::q_char);
         } else {
-            return left.second > right.second;
+            _live.sourceFiles.erase(Include{ filePath, Include::Type::q_char });
         }
     };
-    std::set<include_counter_map_type::value_type, decltype(counterLess)> sortedIncludeCounters{counterLess};
-    for(const auto& counter : includesCounter) {
-        sortedIncludeCounters.insert(counter);
+    for(const auto& event : _events) {
+        if(event.type == Watcher::Event::Type::overflow) {
+            // Everything needs to be read again
+            filesMoved = true;
+            for(IncludeGraph::node_id_type node = 0; node < graph.size(); ++node) {
+                if(graph.node(node).scanned) {
+                    changedFiles.insert(graph.files().path(node).native());
+                }
+            }
+            continue;
+        }
+
+        filesMoved = filesMoved || event.type != Watcher::Event::Type::modified;
+        if(event.directory) {
+            if(event.type == Watcher::Event::Type::created) {
+                _watcher.addDirectory(event.path, true);
+                // Files may have been put into the directory before it was watched
+                std::error_code errorCode;
+                for(recursive_directory_iterator entries{ event.path, errorCode }, end; !errorCode && entries != end; entries.increment(errorCode)) {
+                    updateSourceFile(entries->path());
+                }
+            } else {
+                // Files of the removed directory are not reported one by one
+                const auto directoryPath = weakly_canonical(event.path);
+                for(auto sourceFile = _live.sourceFiles.begin(); sourceFile != _live.sourceFiles.end();) {
+                    if(utils::isWithinDirectory(sourceFile->path, directoryPath)) {
+                        sourceFile = _live.sourceFiles.erase(sourceFile);
+                    } else {
+                        ++sourceFile;
+                    }
+                }
+            }
+            continue;
+        }
+
+        updateSourceFile(event.path);
+    }
+
+    if(filesMoved) {
+        // Directory content changed, so any include may be resolved differently now
+        _live.resolver.clear();
     }
+    _live.roots = addSourceFiles(graph, _live.sourceFiles, _live.contexts);
 
-    for(const auto& counter : sortedIncludeCounters) {
-        std::cout << counter.first.first << " " << counter.second << std::endl;
+    std::vector<IncludeGraph::node_id_type> changedNodes;
+    for(const auto& filePath : changedFiles) {
+        std::error_code errorCode;
+        if(!is_regular_file(filePath, errorCode)) {
+            continue;
+        }
+        // The file is read again within each context it was read within
+        for(FileTable::context_type context = 0; context < graph.files().contextsCount(); ++context) {
+            const auto node = graph.files().find(filePath, context);
+            if(node != FileTable::invalid_file && graph.node(node).scanned) {
+                changedNodes.push_back(node);
+            }
+        }
+    }
+    for(const auto root : _live.roots) {
+        if(!graph.node(root).scanned) {
+            changedNodes.push_back(root);
+        }
+    }
+
+    try {
+        scanFiles(graph, _live.resolver, changedNodes, _options);
+        if(filesMoved) {
+            relinkFiles(graph, _live.resolver, _options);
+        }
+    } catch(const std::exception& exc) {
+        // Files may disappear while they are being read, the following events fix the graph up
+        std::cerr << exc.what() << std::endl;
+    }
+    assignDisplayPaths(graph, _live.roots);
+    if(_options.cache) {
+        _options.cache->save();
+    }
+    watchFileDirectories(graph, _watcher);
+}
+
+void tdw::Analyser::watchFileDirectories(const IncludeGraph& _graph, Watcher& _watcher) {
+    // Files outside of the watched directories may be reached through relative includes
+    for(IncludeGraph::node_id_type node = 0; node < _graph.size(); ++node) {
+        if(_graph.files().found(node)) {
+            _watcher.addDirectory(_graph.files().path(node).parent_path(), false);
+        }
+    }
+}
+
+void tdw::Analyser::watch(const std::vector<path_type>& _includePaths, const BuildOptions& _options, const TreeOptions& _treeOptions, OutputWriter& _output) const {
+    constexpr auto settleTime = std::chrono::milliseconds{ 20 };
+
+    Watcher watcher;
+    LiveGraph live{ _includePaths };
+    loadLiveGraph(live, watcher, _includePaths, _options);
+    printDependencyTree(live.graph, live.roots, live.sourceFiles, _treeOptions, _output);
+
+    // Counters which were last reported. Files, which are not reachable anymore, are reported with zero counter
+    include_counter_type reportedCounter;
+    std::vector<bool> reportedFiles;
+    auto countFiles = [&live](include_counter_type& _includeCounter, std::vector<bool>& _reachedFiles) {
+        _includeCounter = countIncludes(live.graph, live.roots);
+        mergeContexts(live.graph, _includeCounter);
+
+        _reachedFiles.assign(live.graph.size(), false);
+        for(const auto root : live.roots) {
+            _reachedFiles[live.graph.files().primary(root)] = true;
+        }
+        for(IncludeGraph::node_id_type node = 0; node < live.graph.size(); ++node) {
+            _reachedFiles[node] = _reachedFiles[node] || _includeCounter[node];
+        }
+    };
+    countFiles(reportedCounter, reportedFiles);
+    _output.flush();
+
+    while(true) {
+        updateLiveGraph(live, watcher, watcher.wait(settleTime), _options);
+
+        include_counter_type includeCounter;
+        std::vector<bool> reachedFiles;
+        countFiles(includeCounter, reachedFiles);
+        reportedCounter.resize(live.graph.size(), 0);
+        reportedFiles.resize(live.graph.size(), false);
+
+        std::vector<IncludeGraph::node_id_type> changedCounters;
+        for(IncludeGraph::node_id_type node = 0; node < live.graph.size(); ++node) {
+            if(includeCounter[node] != reportedCounter[node] || reachedFiles[node] != reportedFiles[node]) {
+                changedCounters.push_back(node);
+            }
+        }
+
+        if(!changedCounters.empty()) {
+            _output.write('\n');
+            printIncludeCounters(live.graph, includeCounter, std::move(changedCounters), _output);
+            _output.flush();
+        }
+        reportedCounter = std::move(includeCounter);
+        reportedFiles = std::move(reachedFiles);
+    }
+}
+
+void tdw::Analyser::serve(const std::vector<path_type>& _includePaths,
+                          const BuildOptions& _options,
+                          const TreeOptions& _treeOptions,
+                          const path_type& _socketPath) const {
+    constexpr auto settleTime = std::chrono::milliseconds{ 20 };
+
+    Watcher watcher;
+    LiveGraph live{ _includePaths };
+    loadLiveGraph(live, watcher, _includePaths, _options);
+    SocketServer server{ _socketPath };
+
+    // Both are dropped once the graph changes
+    std::unordered_map<std::string, std::string> answers;
+    std::optional<ReverseIndex> index;
+    while(true) {
+        auto filesChanged = false;
+        const auto requests = server.wait(watcher.nativeHandle(), filesChanged);
+        if(filesChanged) {
+            updateLiveGraph(live, watcher, watcher.wait(settleTime), _options);
+            answers.clear();
+            index.reset();
+        }
+
+        auto stopping = false;
+        for(const auto& request : requests) {
+            const auto separator = request.line.find(' ');
+            const auto command = request.line.substr(0, separator);
+            const auto argument = separator == std::string::npos ? std::string{} : request.line.substr(separator + 1);
+            if(stopping) {
+                // The requests, which arrived along with `stop`, are not left without a response
+                server.replyError(request.client, "The server is stopping");
+                continue;
+            } else if(command == "stop") {
+                server.reply(request.client, std::string_view{});
+                stopping = true;
+                continue;
+            }
+
+            auto answer = answers.find(request.line);
+            if(answer == answers.end()) {
+                std::string text;
+                try {
+                    OutputWriter output{ text };
+                    if(command == "tree") {
+                        printDependencyTree(live.graph, live.roots, live.sourceFiles, _treeOptions, output);
+                    } else if(command == "counts") {
+                        auto includeCounter = countIncludes(live.graph, live.roots);
+                        mergeContexts(live.graph, includeCounter);
+                        printIncludeCounters(live.graph, includeCounter, primaryNodes(live.graph), output);
+                    } else if(command == "who-includes" || command == "impact") {
+                        if(!index) {
+                            index.emplace(live.graph);
+                        }
+                        if(command == "impact") {
+                            printImpact(live.graph, *index, live.roots, _options.jobs, output);
+                        } else {
+                            printIncluders(live.graph, *index, argument, output);
+                        }
+                    } else if(command == "cycles") {
+                        printCycles(live.graph, output);
+                    } else {
+                        throw std::invalid_argument{ "Unknown query: \"" + command + "\"" };
+                    }
+                    output.flush();
+                } catch(const std::exception& exc) {
+                    // A failed query (e.g. a file system error) must not stop the server
+                    server.replyError(request.client, exc.what());
+                    continue;
+                }
+                answer = answers.emplace(request.line, std::move(text)).first;
+            }
+            server.reply(request.client, answer->second);
+        }
+
+        if(stopping) {
+            server.drain();
+            return;
+        }
     }
 }
 #pragma endregion
@@ -1,9 +1,25 @@
 #pragma once
 
-#include <map>
-#include <iostream>
+#include "CompilationDatabase.hpp"
+#include "DirectoryWalker.hpp"
+#include "GraphExporter.hpp"
+#include "Include.hpp"
+#include "IncludeGraph.hpp"
+#include "IncludeResolver.hpp"
+#include "MacroTable.hpp"
+#include "OutputWriter.hpp"
+#include "ReverseIndex.hpp"
+#include "ScanCache.hpp"
+#include "Statistics.hpp"
+#include "Watcher.hpp"
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
 #include <unordered_set>
 #include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
 
 namespace tdw {
 
@@ -11,121 +27,324 @@ namespace tdw {
     public:
         using path_type = typename std::filesystem::path;
 
-    private:
-        /**
-         * @brief `first` of the pair denotes the presentational part (which is used to print the entity in the user-friendly manner)
-         * I.e. it should be recognizable and kept in the form originally found in the source files, if the record originates from within
-         * an `#include` directive or a source file path relative to the given source files folder argument
-         * `second` *must* contain the complement part, required to form a (weakly) canonical path to the source file. It's used to uniquely
-         * differentiate between keys.
-        */
-        using include_map_key_type = typename std::pair<path_type, path_type>;
-        struct IncludeMapKeyLess {
-            bool operator()(const include_map_key_type& _left, const include_map_key_type& _right) const {
-                // Checks whether the it's the same values;
-                const auto leftPath = weakly_canonical(_left.second / _left.first);
-                const auto rightPath = weakly_canonical(_right.second / _right.first);
-                if(leftPath == rightPath) {
-                    return false;
-                }
-
-                // Lexical comparison (alphabetical) for "short" names;
-                return _left.first < _right.first;
-            }
-        };
-        struct IncludeMapKeyHash {
-            size_t operator()(const include_map_key_type& _include) const {
-                return std::hash<path_type::string_type>()(weakly_canonical(_include.second / _include.first).native());
-            }
+        struct BuildOptions {
+            // Number of threads reading the files. The resulting graph doesn't depend on it, except for the node identifiers
+            unsigned jobs = 1;
+            // Cache of the includes found during the previous runs, not used if null
+            ScanCache* cache = nullptr;
+            // Profiling counters, not collected if null
+            Statistics* statistics = nullptr;
+            // Scan only the leading preprocessor region of each file, the includes following the first line of code are missed
+            bool preambleOnly = false;
+            // Macros to evaluate the conditional directives with, the includes of all the groups are reported if null
+            const MacroTable* macros = nullptr;
         };
-        struct IncludeMapKeyEqualTo {
-            bool operator()(const include_map_key_type& _left, const include_map_key_type& _right) const {
-                const auto leftPath = weakly_canonical(_left.second / _left.first);
-                const auto rightPath = weakly_canonical(_right.second / _right.first);
-                return leftPath == rightPath;
-            }
+
+        struct SourceOptions {
+            // Number of threads walking the source directory
+            unsigned jobs = 1;
+            // Files of the source directory to analyse
+            DirectoryWalker::Filter filter{ { ".hpp", ".cpp" }, {} };
         };
-        using include_counter_map_type = std::map<include_map_key_type, unsigned, IncludeMapKeyLess>;
-        using include_chain_set_type = std::unordered_set<include_map_key_type, IncludeMapKeyHash, IncludeMapKeyEqualTo>;
-
-        struct Include {
-            enum class Type {
-                q_char, h_char, pp_tokens
-            };
-
-            const path_type path;
-            const Type type;
-
-            Include(const path_type& _path, Type _type) : path{ _path }, type{ _type } {}
-
-            struct HashFunction {
-                size_t operator()(const Include& _include) const {
-                    const auto pathHash = std::hash<path_type::string_type>()(_include.path.native());
-                    const auto typeHash = std::hash<Type>()(_include.type) << 1;
-                    return pathHash ^ typeHash;
-                }
-            };
-
-            struct EqualTo {
-                bool operator()(const Include& _left, const Include& _right) const {
-                    return (_left.path == _right.path) && (_left.type == _right.type);
-                }
-            };
+
+        struct TreeOptions {
+            // Number of include levels printed below each source file, the files at the last level are marked with `(+)`
+            unsigned maxDepth = std::numeric_limits<unsigned>::max();
+            // Print the subtree of each file only once, the later occurrences of the file are marked with `(*)`
+            bool collapseRepeated = false;
         };
+
+        // Number of includes for each file, indexed by `IncludeGraph::node_id_type`. The number of include chains may grow
+        // exponentially with the graph size, hence the wide counter
+        using include_counter_type = std::vector<std::uint64_t>;
+
+    private:
+        // Marks the files of the current include chain, indexed by `IncludeGraph::node_id_type`
+        using include_chain_type = std::vector<bool>;
+
+        // Quoted include spellings of the tree records, indexed by `IncludeGraph::node_id_type` and then by the edge
+        using edge_records_type = std::vector<std::vector<std::string>>;
+
         using source_files_type = std::unordered_set<Include, Include::HashFunction, Include::EqualTo>;
 
-        static std::vector<Include> getIncludes(const path_type& _path);
         /**
-         * @return `path_type` the source was found in or empty `path_type` it search fails
+         * @brief Scans the file for the includes. Consults the cache first (if any), and keeps the result in it
+         * @param _guarded - set to whether the file is protected from being included twice
         */
-        static path_type findIncludeParentPath(const Include& _sourceFile, const path_type _currentPath, const std::vector<path_type>& _includePaths);
+        static std::vector<Include> getIncludes(const path_type& _path, const BuildOptions& _options, bool& _guarded);
         /**
-         * @brief Prints dependency tree for the given `Include` argument with respect to current and include paths.
-         * @param _sourceFile - the include statement
-         * @param _currentPath - the relative "current" directore search needs to be done in relation to
-         * @param _includePaths - include directories to look for includes in
+         * @brief Prints dependency tree for the given graph node with respect to the include it was reached through.
+         * @param _graph - the include graph built for the source files
+         * @param _edgeRecords - the quoted include spellings for each edge of the graph
+         * @param _record - the quoted include spelling the node is reached through
+         * @param _node - the node the include resolves to
          * @param _includeCounter - a collection keeping track of includes number for the given argument
          * @param _includeChain - a collection keeping track of the current include chain
+         * @param _expandedFiles - a collection keeping track of the files, which subtrees were printed already
+         * @param _unitFiles - a collection keeping track of the files, which subtrees were printed for the current source file
+         * @param _treeOptions - the limits of the tree
+         * @param _output - the sink the tree is written to
          * @param _depth - current depth of include chain
-         * @return `path_type` of the directory the given include was found in. The path is empty, if its parent was not found
-        */
-        static path_type printDependencyTree(const Include& _sourceFile,
-                                             const path_type _currentPath,
-                                             const std::vector<path_type>& _includePaths,
-                                             include_counter_map_type& _includeCounter,
-                                             include_chain_set_type& _includeChain,
-                                             unsigned _depth = 0);
-
-        static inline void printIncludeBranchRecord(path_type _path, unsigned _depth, bool _found, bool _cycleInclude, path_type relative_to_path = path_type{}) {
-            if(_depth) {
-                std::cout << std::string(_depth, '_'); // Underscorde instead of dot for the better distinctions with special paths ("." and "..")
-            }
-            
-            // avoid using "make_preferred()", to keep the output consistent with include directive
-            if(relative_to_path.empty()) {
-                std::cout << _path;
-            } else {
-
-                std::cout << std::filesystem::relative(_path, relative_to_path);
-            }
-            
-            if(!_found) {
-                std::cout << "(!)";
-            }
-
-            if(_cycleInclude) {
-                std::cout << "(~)";
-            }
-            std::cout << std::endl;
-        }
-        
+        */
+        static void printDependencyTree(const IncludeGraph& _graph,
+                                        const edge_records_type& _edgeRecords,
+                                        std::string_view _record,
+                                        IncludeGraph::node_id_type _node,
+                                        include_counter_type& _includeCounter,
+                                        include_chain_type& _includeChain,
+                                        include_chain_type& _expandedFiles,
+                                        include_chain_type& _unitFiles,
+                                        const TreeOptions& _treeOptions,
+                                        OutputWriter& _output,
+                                        unsigned _depth = 0);
+        /**
+         * @brief Prepares the records of the tree once, so printing doesn't compute paths for every include chain
+         * @return the quoted include spellings for each edge of the graph, indexed the same way the edges are
+        */
+        static edge_records_type makeEdgeRecords(const IncludeGraph& _graph);
+
+        /**
+         * @return whether a guarded file is reachable from each node of the graph, or an empty collection if there are no guarded files
+        */
+        static include_chain_type reachGuardedFiles(const IncludeGraph& _graph, const std::vector<std::vector<IncludeGraph::node_id_type>>& _components);
+        /**
+         * @brief Checks whether a guarded file may be included more than once within the source file, i.e. whether its repeated
+         * includes change the counters. Visits each file leading to a guarded file at most once
+         * @param _guardedReach - result of `reachGuardedFiles`
+         * @param _visited - all unmarked, left unmarked
+         * @param _stack - scratch storage reused between the calls
+        */
+        static bool repeatsGuardedFile(const IncludeGraph& _graph,
+                                       IncludeGraph::node_id_type _root,
+                                       const include_chain_type& _guardedReach,
+                                       include_chain_type& _visited,
+                                       std::vector<IncludeGraph::node_id_type>& _stack);
+        /**
+         * @brief Follows the include chains of a single source file the way its tree does, so the repeated includes of the guarded
+         * files are counted, but not followed. The chains reaching a file, which leads to no guarded file, are left to the condensed pass
+         * @param _guardedReach - result of `reachGuardedFiles`
+         * @param _entryCounter - receives the chains left to the condensed pass
+         * @param _unitFiles - the files, which were included within the source file already
+        */
+        static void countUnitIncludes(const IncludeGraph& _graph,
+                                      IncludeGraph::node_id_type _node,
+                                      const include_chain_type& _guardedReach,
+                                      include_counter_type& _includeCounter,
+                                      include_counter_type& _entryCounter,
+                                      include_chain_type& _includeChain,
+                                      include_chain_type& _unitFiles);
+        /**
+         * @brief Prints the `"file" N` records of the given files, sorted by the number of includes
+        */
+        static void printIncludeCounters(const IncludeGraph& _graph,
+                                         const include_counter_type& _includeCounter,
+                                         std::vector<IncludeGraph::node_id_type> _nodes,
+                                         OutputWriter& _output);
+
+        /**
+         * @brief Same as the public `printIncluders` and `printImpact`, but over the graph built already
+        */
+        static void printIncluders(const IncludeGraph& _graph, const ReverseIndex& _index, const path_type& _file, OutputWriter& _output);
+        static void printImpact(const IncludeGraph& _graph,
+                                const ReverseIndex& _index,
+                                const std::vector<IncludeGraph::node_id_type>& _roots,
+                                unsigned _jobs,
+                                OutputWriter& _output);
+        /**
+         * @brief Prints each group of files including each other through a cycle (a strongly connected component) as a line of
+         * the quoted files, sorted by their paths
+        */
+        static void printCycles(const IncludeGraph& _graph, OutputWriter& _output);
+
+        /**
+         * @brief Reads the given files and every file reachable from them, which was not read yet, and links them into the graph.
+         * Each file is read only once, no matter how many include chains lead to it
+        */
+        static void scanFiles(IncludeGraph& _graph, IncludeResolver& _resolver, const std::vector<IncludeGraph::node_id_type>& _nodes, const BuildOptions& _options);
+        /**
+         * @brief Resolves the includes of all the files read so far again (e.g. once files were added or removed) and reads the files,
+         * which became reachable. Files read before are not read again
+        */
+        static void relinkFiles(IncludeGraph& _graph, IncludeResolver& _resolver, const BuildOptions& _options);
+        /**
+         * @brief Replaces the edges of the node with the given includes and their resolutions.
+         * @return nodes the includes lead to, which were not read yet
+        */
+        static std::vector<IncludeGraph::node_id_type> linkIncludes(IncludeGraph& _graph,
+                                                                    IncludeGraph::node_id_type _node,
+                                                                    const std::vector<Include>& _includes,
+                                                                    const std::vector<const IncludeResolver::Resolution*>& _resolutions);
+        /**
+         * @brief Gives display paths to the files reachable from the roots, which don't have one yet
+        */
+        static void assignDisplayPaths(IncludeGraph& _graph, const std::vector<IncludeGraph::node_id_type>& _roots);
 
         const path_type path;
+        // Tells the source files apart from the rest of the files within `path`
+        const DirectoryWalker::Filter sourceFilter;
         // Container of source files, with absolute paths
         source_files_type sourceFiles;
+        // Whether the source files are listed by a compilation database, rather than found within `path`
+        bool databaseSourceFiles = false;
+        // Distinct sets of include directories of the compilation database
+        std::vector<IncludeResolver::SearchPaths> sourceSearchPaths;
+        // Index into `sourceSearchPaths` of each source file listed by the compilation database
+        std::unordered_map<path_type::string_type, std::size_t> sourceSearchPathIndices;
+
+        /**
+         * @brief Adds a search context to the resolver for each set of include directories of the compilation database. The given
+         * include directories are searched after the ones of the set
+         * @return the contexts, indexed the same way `sourceSearchPaths` is
+        */
+        std::vector<IncludeResolver::context_type> addSearchContexts(IncludeResolver& _resolver, const std::vector<path_type>& _includePaths) const;
+        /**
+         * @brief Adds the given source files to the graph, each within the search context of its include directories.
+         * @param _contexts - the contexts returned by `addSearchContexts`
+         * @return the nodes of `_sourceFiles` (in the iteration order of the container)
+        */
+        std::vector<IncludeGraph::node_id_type> addSourceFiles(IncludeGraph& _graph,
+                                                               const source_files_type& _sourceFiles,
+                                                               const std::vector<IncludeResolver::context_type>& _contexts) const;
+        /**
+         * @brief Prints the dependency tree of each of the source files, followed by the include counters. The counters don't
+         * depend on the tree limits: they are counted over the graph once the tree is limited
+        */
+        void printDependencyTree(const IncludeGraph& _graph,
+                                 const std::vector<IncludeGraph::node_id_type>& _roots,
+                                 const source_files_type& _sourceFiles,
+                                 const TreeOptions& _treeOptions,
+                                 OutputWriter& _output) const;
+        bool isSourceFile(const path_type& _path) const;
+
+        /**
+         * @brief The graph kept in memory while the files are watched, along with everything needed to update it
+        */
+        struct LiveGraph {
+            source_files_type sourceFiles;
+            IncludeGraph graph;
+            IncludeResolver resolver;
+            std::vector<IncludeResolver::context_type> contexts;
+            std::vector<IncludeGraph::node_id_type> roots;
+
+            explicit LiveGraph(const std::vector<path_type>& _includePaths) : resolver{ _includePaths } {}
+        };
+
+        /**
+         * @brief Builds the graph of the source files and starts watching the source and include directories
+        */
+        void loadLiveGraph(LiveGraph& _live, Watcher& _watcher, const std::vector<path_type>& _includePaths, const BuildOptions& _options) const;
+        /**
+         * @brief Reads the changed files again and updates the graph accordingly, new directories are watched as well
+        */
+        void updateLiveGraph(LiveGraph& _live, Watcher& _watcher, const std::vector<Watcher::Event>& _events, const BuildOptions& _options) const;
+        /**
+         * @brief Watches the directories of the files found, since they may lie outside of the watched directories
+        */
+        static void watchFileDirectories(const IncludeGraph& _graph, Watcher& _watcher);
+        /**
+         * @return whether the source file is compiled on its own, rather than included
+        */
+        static bool isTranslationUnit(const path_type& _path);
+        /**
+         * @brief Looks up the nodes of the file: by its path if it exists, otherwise by the display path (e.g. an include spelling)
+         * @throw `std::invalid_argument` if the file is not a part of the graph
+        */
+        static std::vector<IncludeGraph::node_id_type> findNodes(const IncludeGraph& _graph, const path_type& _file);
+        /**
+         * @return the nodes of the graph, one per file: the copies of a file made within the other search contexts are left out
+        */
+        static std::vector<IncludeGraph::node_id_type> primaryNodes(const IncludeGraph& _graph);
+        /**
+         * @brief Adds the counters of the copies of each file made within the other search contexts to the counter of the file's
+         * primary node, the copies are zeroed
+        */
+        static void mergeContexts(const IncludeGraph& _graph, include_counter_type& _counter);
+
     public:
-        explicit Analyser(const path_type& _path);
-        void printDependencyTree(const std::vector<path_type>& _includePaths) const;
+        /**
+         * @brief Analyses the `*.hpp` and `*.cpp` files of the directory
+         * @param _statistics - profiling counters of the source directory walk, not collected if null
+        */
+        explicit Analyser(const path_type& _path, Statistics* _statistics = nullptr);
+        /**
+         * @param _options - the files to analyse and the way the directory is walked
+         * @param _statistics - profiling counters of the source directory walk, not collected if null
+        */
+        Analyser(const path_type& _path, const SourceOptions& _options, Statistics* _statistics = nullptr);
+        /**
+         * @brief Takes the source files from the compilation database instead of walking the directory: the translation units within
+         * `_path`, which exist and are not ignored (the extensions don't matter). Each of them is analysed with its own include
+         * directories, the files compiled with the same directories share the resolved includes. The files included within several
+         * sets of directories are counted as one file
+         * @param _statistics - profiling counters of collecting the source files, not collected if null
+        */
+        Analyser(const path_type& _path, const CompilationDatabase& _database, const SourceOptions& _options, Statistics* _statistics = nullptr);
+
+        std::size_t sourceFilesCount() const {
+            return sourceFiles.size();
+        }
+
+        /**
+         * @brief Reads every source file and every file reachable from them exactly once and links them into a graph.
+         * Source files are presented by their paths relative to `path`, the rest of the files - by the spelling of the include the file
+         * is first reached through (in the order the tree is printed)
+         * @param _includePaths - include directories to look for includes in
+         * @param _options - the way files are read
+         * @return the graph along with the nodes of `sourceFiles` (in the iteration order of the container)
+        */
+        std::pair<IncludeGraph, std::vector<IncludeGraph::node_id_type>> buildIncludeGraph(const std::vector<path_type>& _includePaths, const BuildOptions& _options) const;
+        void printDependencyTree(const std::vector<path_type>& _includePaths, const BuildOptions& _options, const TreeOptions& _treeOptions, OutputWriter& _output) const;
+        /**
+         * @brief Prints the dependency tree and the include counters of the graph built by `buildIncludeGraph`
+        */
+        void printDependencyTree(const IncludeGraph& _graph, const std::vector<IncludeGraph::node_id_type>& _roots, OutputWriter& _output) const;
+        /**
+         * @brief Prints only the include counters, the same as `printDependencyTree` does after the tree. The counters are computed
+         * over the condensed graph instead of walking every include chain
+        */
+        void printIncludeCounters(const std::vector<path_type>& _includePaths, const BuildOptions& _options, OutputWriter& _output) const;
+        /**
+         * @brief Writes the include graph in the given machine-readable format instead of the tree
+        */
+        void exportGraph(const std::vector<path_type>& _includePaths, const BuildOptions& _options, GraphExporter::Format _format, OutputWriter& _output) const;
+        /**
+         * @brief Prints the files including the given one directly or through other files as `"file" N` records, where `N` is
+         * the number of includes in the shortest chain. Records are sorted by `N`, so the direct includers go first
+         * @throw `std::invalid_argument` if the file is not a part of the graph
+        */
+        void printIncluders(const std::vector<path_type>& _includePaths, const BuildOptions& _options, const path_type& _file, OutputWriter& _output) const;
+        /**
+         * @brief Ranks the files by the cost of changing them as `"file" T B` records, where `T` is the number of translation
+         * units including the file directly or through other files, and `B` is the number of bytes those translation units pull
+         * in (the sizes of the units and of every file they include, each file counted once per unit). Records are sorted by `B`
+        */
+        void printImpact(const std::vector<path_type>& _includePaths, const BuildOptions& _options, OutputWriter& _output) const;
+        /**
+         * @brief Counts includes of the files reachable from the roots the same way `printDependencyTree` does, without walking
+         * every include chain. The graph is condensed into strongly connected components, so the chains are counted in bulk by
+         * following the components in topological order. Each chain entering a cycle is counted as following every include
+         * within the cycle once, which matches the tree for a plain ring of files, while the tree follows every path within
+         * a cycle, which has more of them, until it repeats a file. The chains of the source files, which include a guarded file more than once, are
+         * followed one by one instead, since the repeated includes of the guarded files are not followed, down to the files leading
+         * to no guarded file, which are counted in bulk again. That may take as long as the tree does, if a guarded file is reached
+         * through the unguarded files included repeatedly
+         * @return number of includes for each node of the graph
+        */
+        static include_counter_type countIncludes(const IncludeGraph& _graph, const std::vector<IncludeGraph::node_id_type>& _roots);
+        /**
+         * @brief Prints the dependency tree, then keeps the graph in memory and watches the source and include directories.
+         * Changed files are read again and only the counters, which changed, are printed after each change. Never returns
+         * @throw `std::runtime_error` if watching is not supported
+        */
+        [[noreturn]] void watch(const std::vector<path_type>& _includePaths, const BuildOptions& _options, const TreeOptions& _treeOptions, OutputWriter& _output) const;
+        /**
+         * @brief Keeps the graph in memory and answers the queries sent to the Unix domain socket (see `SocketServer`) one per line:
+         * `tree`, `counts`, `who-includes <file>`, `impact` and `cycles` print the same as the corresponding options do, `stop` stops
+         * the server once the responses are sent, the queries received along with it are rejected. The files are watched the same way `watch` does; the answers are kept until some file changes, so the repeated
+         * queries are answered from memory. The `tree` is limited by `_treeOptions`
+         * @throw `std::runtime_error` if watching or serving is not supported
+        */
+        void serve(const std::vector<path_type>& _includePaths, const BuildOptions& _options, const TreeOptions& _treeOptions, const path_type& _socketPath) const;
 
     };
 }
@@ -0,0 +1,195 @@
+#include "Analyser.hpp"
+#include "FileReader.hpp"
+#include "IncludeResolver.hpp"
+#include "IncludeScanner.hpp"
+#include "OutputWriter.hpp"
+#include "Statistics.hpp"
+#include "Utils.hpp"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <variant>
+
+namespace {
+
+    struct Measurement {
+        double seconds;
+        std::size_t files;
+    };
+
+    struct PhaseResult {
+        std::size_t files;
+        // Number of the file system calls the phase made, if known
+        std::optional<std::size_t> fileSystemCalls;
+    };
+
+    Measurement measureGraphBuild(const tdw::Analyser& _analyser, const std::vector<tdw::Analyser::path_type>& _includePaths, unsigned _jobs) {
+        tdw::Analyser::BuildOptions options;
+        options.jobs = _jobs;
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto [graph, roots] = _analyser.buildIncludeGraph(_includePaths, options);
+        const auto finish = std::chrono::steady_clock::now();
+
+        std::size_t files = 0;
+        for(tdw::IncludeGraph::node_id_type node = 0; node < graph.size(); ++node) {
+            files += graph.files().found(node);
+        }
+
+        return Measurement{ std::chrono::duration<double>(finish - start).count(), files };
+    }
+
+    class PhaseTable {
+    public:
+        PhaseTable() {
+            std::cout << std::setw(8) << "phase" << std::setw(12) << "seconds" << std::setw(10) << "files"
+                      << std::setw(14) << "files/sec" << std::setw(12) << "fs calls" << std::setw(14) << "peak RSS MiB" << std::endl;
+        }
+
+        /**
+         * @brief Runs the phase, which returns `PhaseResult`, and prints its measurements
+        */
+        template<typename Phase>
+        void measure(const char* _name, Phase&& _phase) {
+            const auto start = std::chrono::steady_clock::now();
+            const PhaseResult result = _phase();
+            const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            std::cout << std::fixed << std::setprecision(4)
+                      << std::setw(8) << _name
+                      << std::setw(12) << seconds
+                      << std::setw(10) << result.files
+                      << std::setw(14) << std::setprecision(1) << result.files / seconds
+                      << std::setw(12) << (result.fileSystemCalls ? std::to_string(*result.fileSystemCalls) : std::string{ "-" })
+                      << std::setw(14) << tdw::Statistics::peakMemory() / (1024.0 * 1024.0) << std::endl;
+        }
+    };
+
+    /**
+     * @brief Measures each phase of the analysis on its own in a single thread: the source directory walk, reading and scanning
+     * the files, resolving the includes, counting and printing the tree (into the null device)
+    */
+    void measurePhases(const tdw::Analyser::path_type& _sourcePath, const std::vector<tdw::Analyser::path_type>& _includePaths) {
+#ifdef _WIN32
+        const tdw::OutputWriter::path_type nullDevice{ "NUL" };
+#else
+        const tdw::OutputWriter::path_type nullDevice{ "/dev/null" };
+#endif
+
+        PhaseTable table;
+        std::optional<tdw::Analyser> analyser;
+        table.measure("scan", [&] {
+            analyser.emplace(_sourcePath);
+            return PhaseResult{ analyser->sourceFilesCount(), std::nullopt };
+        });
+
+        // The graph tells which files the rest of the phases deal with
+        const auto [graph, roots] = analyser->buildIncludeGraph(_includePaths, tdw::Analyser::BuildOptions{});
+        std::vector<tdw::IncludeGraph::node_id_type> files;
+        for(tdw::IncludeGraph::node_id_type node = 0; node < graph.size(); ++node) {
+            if(graph.files().found(node)) {
+                files.push_back(node);
+            }
+        }
+
+        table.measure("parse", [&] {
+            tdw::FileReader reader;
+            for(const auto node : files) {
+                tdw::IncludeScanner{ reader.read(graph.files().path(node)) }.scan();
+            }
+            // Each file is opened once
+            return PhaseResult{ files.size(), files.size() };
+        });
+
+        table.measure("resolve", [&] {
+            tdw::IncludeResolver resolver{ _includePaths };
+            for(const auto node : files) {
+                const auto directoryPath = graph.files().path(node).parent_path();
+                for(const auto& edge : graph.node(node).edges) {
+                    resolver.resolve(edge.include(), directoryPath);
+                }
+            }
+            const auto statistics = resolver.statistics();
+            return PhaseResult{ files.size(), statistics.directoryListings + statistics.canonicalizations };
+        });
+
+        table.measure("count", [&] {
+            tdw::Analyser::countIncludes(graph, roots);
+            return PhaseResult{ files.size(), 0 };
+        });
+
+        table.measure("print", [&] {
+            tdw::OutputWriter output{ nullDevice };
+            analyser->printDependencyTree(graph, roots, output);
+            output.flush();
+            return PhaseResult{ files.size(), 0 };
+        });
+        std::cout << std::endl;
+    }
+
+}
+
+/**
+ * @brief Measures each phase of the analysis, then how the graph construction (reading, scanning and resolving the files) scales
+ * with the number of threads. Accepts the same arguments as `dinclude`, `--jobs` sets the maximum number of threads to measure
+ * (the hardware concurrency by default)
+*/
+int main(int argc, char* argv[]) {
+
+    try {
+        const auto arguments = tdw::utils::readArguments(argc, argv);
+        tdw::utils::assertCompliantArguments(arguments);
+
+        auto argIterator = arguments.cbegin();
+        const auto sourcePath = std::get<std::string>(*argIterator++);
+
+        std::vector<tdw::Analyser::path_type> includePaths;
+        auto maxJobs = std::max(std::thread::hardware_concurrency(), 1u);
+        for(; argIterator != arguments.cend(); ++argIterator) {
+            const auto& optionArgument = std::get<tdw::utils::option_type>(*argIterator);
+            if(optionArgument.first.shortVersion == "I") {
+                includePaths.emplace_back(optionArgument.second);
+            } else if(optionArgument.first.shortVersion == "j") {
+                maxJobs = tdw::utils::positiveNumberArgument(optionArgument);
+            }
+        }
+
+        // Warms up the file system caches, so the first measurement is not penalized
+        const tdw::Analyser analyser{ sourcePath };
+        measureGraphBuild(analyser, includePaths, maxJobs);
+
+        measurePhases(sourcePath, includePaths);
+
+        std::cout << std::setw(6) << "jobs" << std::setw(12) << "seconds" << std::setw(10) << "files"
+                  << std::setw(14) << "files/sec" << std::setw(10) << "speedup" << std::endl;
+
+        // Powers of two up to the maximum, which is always measured
+        std::vector<unsigned> jobCounts;
+        for(auto jobs = 1u; jobs < maxJobs; jobs *= 2) {
+            jobCounts.push_back(jobs);
+        }
+        jobCounts.push_back(maxJobs);
+
+        double baseline = 0;
+        for(const auto jobs : jobCounts) {
+            const auto measurement = measureGraphBuild(analyser, includePaths, jobs);
+            if(jobs == 1) {
+                baseline = measurement.seconds;
+            }
+
+            std::cout << std::fixed << std::setprecision(4)
+                      << std::setw(6) << jobs
+                      << std::setw(12) << measurement.seconds
+                      << std::setw(10) << measurement.files
+                      << std::setw(14) << std::setprecision(1) << measurement.files / measurement.seconds
+                      << std::setw(10) << std::setprecision(2) << baseline / measurement.seconds << std::endl;
+        }
+    } catch(const std::exception& exc) {
+        std::cerr << std::endl << exc.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,311 @@
+#include "CompilationDatabase.hpp"
+#include "MappedFile.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace {
+
+    /**
+     * @brief Reader of the JSON subset the compilation databases consist of. Values, which are not needed, are skipped
+    */
+    class JsonReader {
+    public:
+        explicit JsonReader(std::string_view _data) : data{ _data } {}
+
+        bool atEnd() {
+            skipSpace();
+            return position >= data.size();
+        }
+
+        /**
+         * @return `true` if the next character is the given one, which is consumed then
+        */
+        bool consume(char _character) {
+            skipSpace();
+            if(position < data.size() && data[position] == _character) {
+                ++position;
+                return true;
+            }
+            return false;
+        }
+
+        void expect(char _character) {
+            if(!consume(_character)) {
+                fail();
+            }
+        }
+
+        bool nextIsString() {
+            skipSpace();
+            return position < data.size() && data[position] == '"';
+        }
+
+        std::string readString() {
+            expect('"');
+            std::string value;
+            while(position < data.size() && data[position] != '"') {
+                const auto character = data[position++];
+                if(character != '\\') {
+                    value.push_back(character);
+                    continue;
+                }
+                if(position >= data.size()) {
+                    fail();
+                }
+                switch(const auto escaped = data[position++]) {
+                    case 'b': value.push_back('\b'); break;
+                    case 'f': value.push_back('\f'); break;
+                    case 'n': value.push_back('\n'); break;
+                    case 'r': value.push_back('\r'); break;
+                    case 't': value.push_back('\t'); break;
+                    case 'u': appendCodePoint(value, readCodePoint()); break;
+                    default: value.push_back(escaped); break;
+                }
+            }
+            expect('"');
+            return value;
+        }
+
+        void skipValue() {
+            skipSpace();
+            if(position >= data.size()) {
+                fail();
+            } else if(data[position] == '"') {
+                readString();
+            } else if(consume('[')) {
+                if(!consume(']')) {
+                    do {
+                        skipValue();
+                    } while(consume(','));
+                    expect(']');
+                }
+            } else if(consume('{')) {
+                if(!consume('}')) {
+                    do {
+                        readString();
+                        expect(':');
+                        skipValue();
+                    } while(consume(','));
+                    expect('}');
+                }
+            } else {
+                // Numbers and literals
+                const auto end = data.find_first_of(",]} \t\r\n", position);
+                position = end == std::string_view::npos ? data.size() : end;
+            }
+        }
+
+        [[noreturn]] void fail() const {
+            throw std::invalid_argument{ "Malformed compilation database at offset " + std::to_string(position) };
+        }
+
+    private:
+        void skipSpace() {
+            while(position < data.size() && (data[position] == ' ' || data[position] == '\t' || data[position] == '\r' || data[position] == '\n')) {
+                ++position;
+            }
+        }
+
+        unsigned readHex() {
+            if(data.size() - position < 4) {
+                fail();
+            }
+            unsigned value = 0;
+            for(auto i = 0; i < 4; ++i) {
+                const auto character = data[position++];
+                value <<= 4;
+                if(character >= '0' && character <= '9') {
+                    value |= static_cast<unsigned>(character - '0');
+                } else if(character >= 'a' && character <= 'f') {
+                    value |= static_cast<unsigned>(character - 'a' + 10);
+                } else if(character >= 'A' && character <= 'F') {
+                    value |= static_cast<unsigned>(character - 'A' + 10);
+                } else {
+                    fail();
+                }
+            }
+            return value;
+        }
+
+        unsigned readCodePoint() {
+            const auto value = readHex();
+            // Surrogate pair
+            if(value >= 0xD800 && value < 0xDC00 && data.substr(position, 2) == "\\u") {
+                position += 2;
+                const auto low = readHex();
+                return 0x10000 + ((value - 0xD800) << 10) + (low - 0xDC00);
+            }
+            return value;
+        }
+
+        static void appendCodePoint(std::string& _value, unsigned _codePoint) {
+            if(_codePoint < 0x80) {
+                _value.push_back(static_cast<char>(_codePoint));
+            } else if(_codePoint < 0x800) {
+                _value.push_back(static_cast<char>(0xC0 | (_codePoint >> 6)));
+                _value.push_back(static_cast<char>(0x80 | (_codePoint & 0x3F)));
+            } else if(_codePoint < 0x10000) {
+                _value.push_back(static_cast<char>(0xE0 | (_codePoint >> 12)));
+                _value.push_back(static_cast<char>(0x80 | ((_codePoint >> 6) & 0x3F)));
+                _value.push_back(static_cast<char>(0x80 | (_codePoint & 0x3F)));
+            } else {
+                _value.push_back(static_cast<char>(0xF0 | (_codePoint >> 18)));
+                _value.push_back(static_cast<char>(0x80 | ((_codePoint >> 12) & 0x3F)));
+                _value.push_back(static_cast<char>(0x80 | ((_codePoint >> 6) & 0x3F)));
+                _value.push_back(static_cast<char>(0x80 | (_codePoint & 0x3F)));
+            }
+        }
+
+        const std::string_view data;
+        std::size_t position = 0;
+    };
+
+    /**
+     * @brief Splits the command the way a POSIX shell does: by whitespaces, respecting the quotes and the backslash escapes
+    */
+    std::vector<std::string> splitCommand(std::string_view _command) {
+        std::vector<std::string> arguments;
+        std::string argument;
+        auto inArgument = false;
+        for(std::size_t i = 0; i < _command.size(); ++i) {
+            const auto character = _command[i];
+            if(character == ' ' || character == '\t' || character == '\n') {
+                if(inArgument) {
+                    arguments.push_back(std::move(argument));
+                    argument.clear();
+                    inArgument = false;
+                }
+                continue;
+            }
+
+            inArgument = true;
+            if(character == '\\' && i + 1 < _command.size()) {
+                argument.push_back(_command[++i]);
+            } else if(character == '\'') {
+                const auto end = _command.find('\'', i + 1);
+                argument.append(_command.substr(i + 1, end - i - 1));
+                i = end == std::string_view::npos ? _command.size() : end;
+            } else if(character == '"') {
+                for(++i; i < _command.size() && _command[i] != '"'; ++i) {
+                    // Within double quotes the backslash escapes only the characters special there
+                    if(_command[i] == '\\' && i + 1 < _command.size() && std::string_view{ "\"\\$`" }.find(_command[i + 1]) != std::string_view::npos) {
+                        ++i;
+                    }
+                    argument.push_back(_command[i]);
+                }
+            } else {
+                argument.push_back(character);
+            }
+        }
+        if(inArgument) {
+            arguments.push_back(std::move(argument));
+        }
+
+        return arguments;
+    }
+
+}
+
+#pragma region Lifecycle
+tdw::CompilationDatabase::CompilationDatabase(const path_type& _databasePath) {
+    const MappedFile file{ _databasePath };
+    JsonReader reader{ file.view() };
+
+    reader.expect('[');
+    if(!reader.consume(']')) {
+        do {
+            path_type directory;
+            path_type filePath;
+            std::vector<std::string> arguments;
+            reader.expect('{');
+            if(!reader.consume('}')) {
+                do {
+                    const auto key = reader.readString();
+                    reader.expect(':');
+                    if(key == "directory" && reader.nextIsString()) {
+                        directory = std::filesystem::u8path(reader.readString());
+                    } else if(key == "file" && reader.nextIsString()) {
+                        filePath = std::filesystem::u8path(reader.readString());
+                    } else if(key == "command" && reader.nextIsString()) {
+                        arguments = splitCommand(reader.readString());
+                    } else if(key == "arguments" && reader.consume('[')) {
+                        // Takes precedence over the "command"
+                        arguments.clear();
+                        if(!reader.consume(']')) {
+                            do {
+                                arguments.push_back(reader.readString());
+                            } while(reader.consume(','));
+                            reader.expect(']');
+                        }
+                    } else {
+                        reader.skipValue();
+                    }
+                } while(reader.consume(','));
+                reader.expect('}');
+            }
+
+            if(filePath.empty()) {
+                reader.fail();
+            }
+            addEntry(directory, filePath, arguments);
+        } while(reader.consume(','));
+        reader.expect(']');
+    }
+    if(!reader.atEnd()) {
+        reader.fail();
+    }
+}
+#pragma endregion
+
+#pragma region Actions
+void tdw::CompilationDatabase::addEntry(const path_type& _directory, const path_type& _file, const std::vector<std::string>& _arguments) {
+    // Relative paths of the entry are relative to its directory, which is relative to the current one if it's relative as well
+    const auto directory = std::filesystem::absolute(_directory);
+    const auto absolutePath = [&directory](const std::string& _path) {
+        return (directory / std::filesystem::u8path(_path)).lexically_normal();
+    };
+
+    IncludeResolver::SearchPaths searchPaths;
+    std::vector<path_type> systemPaths;
+    std::vector<path_type> afterPaths;
+    for(std::size_t i = 1; i < _arguments.size(); ++i) {
+        const std::string_view argument{ _arguments[i] };
+        std::vector<path_type>* target = nullptr;
+        std::string_view flag;
+        if(argument.substr(0, 2) == "-I") {
+            target = &searchPaths.includePaths;
+            flag = "-I";
+        } else if(argument.substr(0, 7) == "-iquote") {
+            target = &searchPaths.quotePaths;
+            flag = "-iquote";
+        } else if(argument.substr(0, 8) == "-isystem") {
+            target = &systemPaths;
+            flag = "-isystem";
+        } else if(argument.substr(0, 10) == "-idirafter") {
+            target = &afterPaths;
+            flag = "-idirafter";
+        } else {
+            continue;
+        }
+
+        // Both the attached (`-Idir`) and the separate (`-I dir`) forms are accepted
+        if(argument.size() > flag.size()) {
+            target->push_back(absolutePath(std::string{ argument.substr(flag.size()) }));
+        } else if(i + 1 < _arguments.size()) {
+            target->push_back(absolutePath(_arguments[++i]));
+        }
+    }
+    // The system directories are searched after the ordinary ones, no matter the order of the flags
+    searchPaths.includePaths.insert(searchPaths.includePaths.end(), systemPaths.cbegin(), systemPaths.cend());
+    searchPaths.includePaths.insert(searchPaths.includePaths.end(), afterPaths.cbegin(), afterPaths.cend());
+
+    const auto it = std::find(searchPathSets.cbegin(), searchPathSets.cend(), searchPaths);
+    const auto index = static_cast<std::size_t>(it - searchPathSets.cbegin());
+    if(it == searchPathSets.cend()) {
+        searchPathSets.push_back(std::move(searchPaths));
+    }
+    units.push_back(Entry{ (directory / _file).lexically_normal(), index });
+}
+#pragma endregion
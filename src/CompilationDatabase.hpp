@@ -0,0 +1,54 @@
+#pragma once
+
+#include "IncludeResolver.hpp"
+#include <filesystem>
+#include <vector>
+
+namespace tdw {
+
+    /**
+     * @brief Translation units of a JSON compilation database (`compile_commands.json`) along with the include directories they
+     * are compiled with. The directories are taken from the `-I`, `-iquote`, `-isystem` and `-idirafter` flags of each command;
+     * the translation units compiled with the same directories share the same set of them
+    */
+    class CompilationDatabase {
+    public:
+        using path_type = typename std::filesystem::path;
+
+        struct Entry {
+            // Absolute path to the translation unit
+            path_type file;
+            // Index of the include directories of the unit in `searchPaths()`
+            std::size_t searchPathsIndex;
+        };
+
+        /**
+         * @throw `std::runtime_error` if the database cannot be read, `std::invalid_argument` if it's malformed
+        */
+        explicit CompilationDatabase(const path_type& _databasePath);
+
+        /**
+         * @return the entries in the order of the database. A file compiled several times is listed each time
+        */
+        const std::vector<Entry>& entries() const {
+            return units;
+        }
+
+        /**
+         * @return distinct sets of the include directories
+        */
+        const std::vector<IncludeResolver::SearchPaths>& searchPaths() const {
+            return searchPathSets;
+        }
+
+    private:
+        /**
+         * @brief Adds the entry of the unit compiled with the given arguments (the compiler itself included)
+        */
+        void addEntry(const path_type& _directory, const path_type& _file, const std::vector<std::string>& _arguments);
+
+        std::vector<Entry> units;
+        std::vector<IncludeResolver::SearchPaths> searchPathSets;
+    };
+
+}
@@ -0,0 +1,200 @@
+#include "DirectoryWalker.hpp"
+#include "Utils.hpp"
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TDW_DIRECTORYWALKER_POSIX 1
+#include "ThreadPool.hpp"
+#include <deque>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+namespace {
+
+    bool matchesAny(const std::vector<std::string>& _patterns, std::string_view _name, std::string_view _relativePath) {
+        for(const auto& pattern : _patterns) {
+            const auto matched = pattern.find('/') == std::string::npos ? tdw::utils::globMatch(pattern, _name) : tdw::utils::globMatch(pattern, _relativePath);
+            if(matched) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::string_view extension(std::string_view _name) {
+        // Same as `std::filesystem::path::extension`: the leading dot doesn't start an extension
+        const auto dot = _name.rfind('.');
+        return dot == std::string_view::npos || dot == 0 ? std::string_view{} : _name.substr(dot);
+    }
+
+}
+
+#pragma region Actions
+bool tdw::DirectoryWalker::Filter::ignores(std::string_view _name, std::string_view _relativePath) const {
+    return matchesAny(ignored, _name, _relativePath);
+}
+
+bool tdw::DirectoryWalker::Filter::includes(std::string_view _name, std::string_view _relativePath) const {
+    return included.empty() || matchesAny(included, _name, _relativePath);
+}
+
+bool tdw::DirectoryWalker::Filter::matchesExtension(std::string_view _name) const {
+    if(extensions.empty()) {
+        return true;
+    }
+
+    const auto fileExtension = extension(_name);
+    for(const auto& expected : extensions) {
+        if(fileExtension == expected) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool tdw::DirectoryWalker::Filter::accepts(const path_type& _relativePath) const {
+    if(!matchesExtension(_relativePath.filename().string())) {
+        return false;
+    }
+    if(ignored.empty() && included.empty()) {
+        return true;
+    }
+
+    std::string relativePath;
+    for(const auto& component : _relativePath) {
+        const auto name = component.string();
+        if(!relativePath.empty()) {
+            relativePath.push_back('/');
+        }
+        relativePath += name;
+        if(ignores(name, relativePath)) {
+            return false;
+        }
+    }
+    return includes(_relativePath.filename().string(), relativePath);
+}
+
+#ifdef TDW_DIRECTORYWALKER_POSIX
+
+std::vector<tdw::DirectoryWalker::path_type> tdw::DirectoryWalker::walk(const path_type& _root) const {
+    constexpr auto noListing = std::numeric_limits<std::size_t>::max();
+
+    // Entries of a directory in the order they were listed, each sub-directory refers to its own listing
+    struct Entry {
+        path_type path;
+        std::size_t listing;
+    };
+    using listing_type = std::vector<Entry>;
+
+    std::mutex listingsMutex;
+    // Guarded by the mutex, the deque keeps the listings in place while it grows
+    std::deque<listing_type> listings(1);
+    ThreadPool pool{ jobs };
+
+    std::function<void(path_type, std::string, std::size_t)> listDirectory = [&](path_type _directoryPath, std::string _relativePath, std::size_t _listing) {
+        auto* directory = ::opendir(_directoryPath.c_str());
+        if(!directory) {
+            if(!_listing) {
+                throw std::runtime_error{ "Could not read the directory: " + _directoryPath.string() };
+            }
+            return;
+        }
+
+        listing_type entries;
+        std::vector<std::pair<std::size_t, std::string>> subdirectories;
+        while(const auto* entry = ::readdir(directory)) {
+            const std::string_view name{ entry->d_name };
+            if(name == "." || name == "..") {
+                continue;
+            }
+
+            auto relativePath = _relativePath.empty() ? std::string{ name } : _relativePath + '/' + std::string{ name };
+            if(filter.ignores(name, relativePath)) {
+                continue;
+            }
+
+            auto entryPath = _directoryPath / name;
+            auto isDirectory = entry->d_type == DT_DIR;
+            auto isFile = entry->d_type == DT_REG;
+            if(entry->d_type == DT_LNK || entry->d_type == DT_UNKNOWN) {
+                // Only the links (and the file systems, which don't report the types) cost a `stat` call
+                struct stat status{};
+                if(entry->d_type == DT_UNKNOWN && ::lstat(entryPath.c_str(), &status) == 0) {
+                    isDirectory = S_ISDIR(status.st_mode);
+                }
+                isFile = !isDirectory && ::stat(entryPath.c_str(), &status) == 0 && S_ISREG(status.st_mode);
+            }
+
+            if(isDirectory) {
+                subdirectories.emplace_back(entries.size(), std::move(relativePath));
+                entries.push_back(Entry{ std::move(entryPath), noListing });
+            } else if(isFile && filter.matchesExtension(name) && filter.includes(name, relativePath)) {
+                entries.push_back(Entry{ std::move(entryPath), noListing });
+            }
+        }
+        ::closedir(directory);
+
+        std::lock_guard lock{ listingsMutex };
+        for(auto& [index, relativePath] : subdirectories) {
+            entries[index].listing = listings.size();
+            listings.emplace_back();
+            pool.submit([&listDirectory, path = entries[index].path, relativePath = std::move(relativePath), listing = entries[index].listing] {
+                listDirectory(path, relativePath, listing);
+            });
+        }
+        listings[_listing] = std::move(entries);
+    };
+
+    pool.submit([&listDirectory, &_root] {
+        listDirectory(_root, std::string{}, 0);
+    });
+    pool.wait();
+
+    // The listings are joined depth-first, the way the recursive iterator goes
+    std::vector<path_type> files;
+    std::vector<std::pair<std::size_t, std::size_t>> stack{ { 0, 0 } };
+    while(!stack.empty()) {
+        auto& [listing, index] = stack.back();
+        if(index == listings[listing].size()) {
+            stack.pop_back();
+            continue;
+        }
+
+        auto& entry = listings[listing][index++];
+        if(entry.listing == noListing) {
+            files.push_back(std::move(entry.path));
+        } else {
+            stack.emplace_back(entry.listing, 0);
+        }
+    }
+
+    return files;
+}
+
+#else
+
+std::vector<tdw::DirectoryWalker::path_type> tdw::DirectoryWalker::walk(const path_type& _root) const {
+    using namespace std::filesystem;
+
+    std::vector<path_type> files;
+    for(recursive_directory_iterator entries{ _root }, end; entries != end; ++entries) {
+        const auto relativePath = entries->path().lexically_relative(_root).generic_string();
+        if(filter.ignores(entries->path().filename().string(), relativePath)) {
+            entries.disable_recursion_pending();
+            continue;
+        }
+        const auto name = entries->path().filename().string();
+        if(entries->is_regular_file() && filter.matchesExtension(name) && filter.includes(name, relativePath)) {
+            files.push_back(entries->path());
+        }
+    }
+
+    return files;
+}
+
+#endif
+#pragma endregion
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tdw {
+
+    /**
+     * @brief Finds the files within a directory tree. The sub-directories are listed concurrently, each by a task of its own;
+     * on POSIX systems the entry types are taken from the listing itself (`d_type`), so the files are not `stat`-ed one by one.
+     * The result is the same as the one of `std::filesystem::recursive_directory_iterator`: symbolic links to files are followed,
+     * to directories - not, and the order is the same as well, no matter how many threads list the directories
+    */
+    class DirectoryWalker {
+    public:
+        using path_type = typename std::filesystem::path;
+
+        struct Filter {
+            // Extensions of the files to find, with the leading dot. Any file is found if empty
+            std::vector<std::string> extensions;
+            // Globs of the files and directories to skip (see `utils::globMatch`). A glob without a slash is matched against
+            // the name of each file and directory, otherwise against its path relative to the root. Skipped directories are not entered
+            std::vector<std::string> ignored;
+            // Globs of the files to find, matched the same way the ignored ones are. Any file is found if empty, the directories
+            // are entered anyway
+            std::vector<std::string> included;
+
+            /**
+             * @param _name - name of the file or directory
+             * @param _relativePath - its path relative to the root, with slashes as separators
+            */
+            bool ignores(std::string_view _name, std::string_view _relativePath) const;
+            bool includes(std::string_view _name, std::string_view _relativePath) const;
+            bool matchesExtension(std::string_view _name) const;
+            /**
+             * @return whether the file with the given path relative to the root would be found, i.e. neither it, nor any of its
+             * directories is skipped
+            */
+            bool accepts(const path_type& _relativePath) const;
+        };
+
+        DirectoryWalker(const Filter& _filter, unsigned _jobs) : filter{ _filter }, jobs{ _jobs } {}
+
+        /**
+         * @return the files found, prefixed with `_root`. Directories, which cannot be listed, are skipped
+         * @throw `std::runtime_error` if the root cannot be listed
+        */
+        std::vector<path_type> walk(const path_type& _root) const;
+
+    private:
+        const Filter& filter;
+        const unsigned jobs;
+    };
+
+}
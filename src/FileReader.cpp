@@ -0,0 +1,68 @@
+#include "FileReader.hpp"
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TDW_FILE_READER_POSIX 1
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#pragma region Actions
+std::string_view tdw::FileReader::read(const path_type& _path) {
+    // The previous file is not needed anymore
+    mapping = MappedFile{};
+
+#ifdef TDW_FILE_READER_POSIX
+    const auto descriptor = ::open(_path.c_str(), O_RDONLY);
+    if(descriptor < 0) {
+        throw std::runtime_error{ "Could not open the file: " + _path.string() };
+    }
+
+    struct stat status;
+    if(::fstat(descriptor, &status) != 0) {
+        ::close(descriptor);
+        throw std::runtime_error{ "Could not read the file: " + _path.string() };
+    }
+
+    const auto fileSize = static_cast<std::size_t>(status.st_size);
+    if(fileSize > smallFileSize) {
+        ::close(descriptor);
+        mapping = MappedFile{ _path };
+        return mapping.view();
+    }
+
+    // The file may change while it's read, so the size is only a hint. The extra byte tells if the file grew past the limit
+    buffer.resize(smallFileSize + 1);
+    std::size_t size = 0;
+    while(size < buffer.size()) {
+        const auto count = ::read(descriptor, buffer.data() + size, buffer.size() - size);
+        if(count < 0 && errno == EINTR) {
+            continue;
+        } else if(count < 0) {
+            ::close(descriptor);
+            throw std::runtime_error{ "Could not read the file: " + _path.string() };
+        } else if(!count) {
+            break;
+        }
+        size += static_cast<std::size_t>(count);
+    }
+    ::close(descriptor);
+
+    if(size > smallFileSize) {
+        mapping = MappedFile{ _path };
+        return mapping.view();
+    }
+    return std::string_view{ buffer.data(), size };
+#else
+    std::ifstream ifs;
+    ifs.exceptions(ifs.exceptions() | std::ios::failbit);
+    ifs.open(_path, std::ios::binary);
+    using if_stream_buf_it = typename std::istreambuf_iterator<std::ifstream::char_type>;
+    buffer.assign(if_stream_buf_it{ ifs }, if_stream_buf_it{});
+    return std::string_view{ buffer.data(), buffer.size() };
+#endif
+}
+#pragma endregion
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "MappedFile.hpp"
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+namespace tdw {
+
+    /**
+     * @brief Reads the files one after another without allocating for each of them. Small files are read into a buffer reused
+     * between the reads, larger ones are memory-mapped, so the memory held doesn't depend on the size of the largest file.
+     * Meant to be owned by a single thread
+    */
+    class FileReader {
+    public:
+        using path_type = typename std::filesystem::path;
+
+        // Files up to this size are read into the buffer, since mapping them costs more than copying
+        static constexpr std::size_t smallFileSize = 64 * 1024;
+
+        FileReader() = default;
+
+        FileReader(const FileReader&) = delete;
+        FileReader& operator=(const FileReader&) = delete;
+
+        /**
+         * @return content of the file, which stays valid until the next read
+         * @throw `std::runtime_error` if the file cannot be opened or read
+        */
+        std::string_view read(const path_type& _path);
+
+    private:
+        std::vector<char> buffer;
+        MappedFile mapping;
+    };
+
+}
@@ -0,0 +1,39 @@
+#include "FileTable.hpp"
+#include <stdexcept>
+
+#pragma region Actions
+std::pair<tdw::FileTable::file_id_type, bool> tdw::FileTable::intern(const path_type& _filePath, context_type _context) {
+    auto& ids = contextIds(_context);
+    const auto alias = ids.aliasIds.find(_filePath.native());
+    if(alias != ids.aliasIds.cend()) {
+        return std::make_pair(alias->second, false);
+    }
+
+    const auto result = add(ids.canonicalIds, std::filesystem::weakly_canonical(_filePath), _context, true);
+    ids.aliasIds.emplace(_filePath.native(), result.first);
+    return result;
+}
+
+std::pair<tdw::FileTable::file_id_type, bool> tdw::FileTable::internMissing(const path_type& _spelling) {
+    return add(missingIds, path_type{ _spelling }, 0, false);
+}
+
+std::pair<tdw::FileTable::file_id_type, bool> tdw::FileTable::add(std::unordered_map<path_type::string_type, file_id_type>& _ids,
+                                                                  path_type&& _path,
+                                                                  context_type _context,
+                                                                  bool _found) {
+    if(files.size() >= invalid_file) {
+        throw std::length_error{ "Too many files to analyse" };
+    }
+
+    const auto id = static_cast<file_id_type>(files.size());
+    const auto [it, inserted] = _ids.try_emplace(_path.native(), id);
+    if(inserted) {
+        // A found file may have been interned within another context before
+        const auto primary = _found ? primaryIds.try_emplace(_path.native(), id).first->second : id;
+        files.push_back(Record{ std::move(_path), path_type{}, _found, _context, primary });
+    }
+
+    return std::make_pair(it->second, inserted);
+}
+#pragma endregion
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tdw {
+
+    /**
+     * @brief Interning table of the files taking part in the analysis. Each file is (weakly) canonicalized once and gets a dense
+     * `file_id_type` identifier, so the rest of the analysis compares and hashes integers instead of paths.
+     * Includes which could not be found are interned as well (by their spelling), so they can be counted in the same manner.
+     * The same file may be interned within several search contexts (e.g. translation units with different include directories
+     * resolve its includes differently), each of them gets its own identifier. The missing files don't depend on the context.
+    */
+    class FileTable {
+    public:
+        using path_type = typename std::filesystem::path;
+        using file_id_type = typename std::uint32_t;
+        using context_type = typename std::uint32_t;
+
+        static constexpr auto invalid_file = std::numeric_limits<file_id_type>::max();
+
+        /**
+         * @brief Looks up the identifier of an existing file, the path is canonicalized only the first time it's met
+         * @return identifier of the file and `true` if the file was not interned before the call
+        */
+        std::pair<file_id_type, bool> intern(const path_type& _filePath, context_type _context = 0);
+
+        /**
+         * @brief Same as `intern`, but skips the canonicalization, since the given path is known to be (weakly) canonical already
+        */
+        std::pair<file_id_type, bool> internCanonical(const path_type& _filePath, context_type _context = 0) {
+            return add(contextIds(_context).canonicalIds, path_type{ _filePath }, _context, true);
+        }
+
+        /**
+         * @brief Looks up the identifier of a file, which could not be found for the given include spelling
+         * @return identifier of the file and `true` if the file was not interned before the call
+        */
+        std::pair<file_id_type, bool> internMissing(const path_type& _spelling);
+
+        /**
+         * @return identifier of the file with the given (weakly) canonical path or `invalid_file` if it's not interned
+        */
+        file_id_type find(const path_type& _filePath, context_type _context = 0) const {
+            if(_context >= contexts.size()) {
+                return invalid_file;
+            }
+            const auto it = contexts[_context].canonicalIds.find(_filePath.native());
+            return it == contexts[_context].canonicalIds.cend() ? invalid_file : it->second;
+        }
+
+        /**
+         * @return (weakly) canonical path to the file or the include spelling, if the file doesn't exist
+        */
+        const path_type& path(file_id_type _id) const {
+            return files[_id].path;
+        }
+
+        const path_type& displayPath(file_id_type _id) const {
+            return files[_id].displayPath;
+        }
+
+        /**
+         * @brief Sets the presentational path of the file, which is kept in the form originally found in the source files
+        */
+        void setDisplayPath(file_id_type _id, const path_type& _displayPath) {
+            files[_id].displayPath = _displayPath;
+        }
+
+        bool found(file_id_type _id) const {
+            return files[_id].found;
+        }
+
+        context_type context(file_id_type _id) const {
+            return files[_id].context;
+        }
+
+        /**
+         * @return identifier of the same file interned first (within another search context), the given one if it was the first
+        */
+        file_id_type primary(file_id_type _id) const {
+            return files[_id].primary;
+        }
+
+        /**
+         * @return number of the search contexts the files were interned within, the missing files aside
+        */
+        context_type contextsCount() const {
+            return static_cast<context_type>(contexts.size());
+        }
+
+        file_id_type size() const {
+            return static_cast<file_id_type>(files.size());
+        }
+
+    private:
+        struct Record {
+            path_type path;
+            path_type displayPath;
+            bool found;
+            context_type context;
+            file_id_type primary;
+        };
+
+        struct ContextIds {
+            // Paths in the form they were requested, so each distinct spelling is canonicalized only once
+            std::unordered_map<path_type::string_type, file_id_type> aliasIds;
+            std::unordered_map<path_type::string_type, file_id_type> canonicalIds;
+        };
+
+        ContextIds& contextIds(context_type _context) {
+            if(_context >= contexts.size()) {
+                contexts.resize(static_cast<std::size_t>(_context) + 1);
+            }
+            return contexts[_context];
+        }
+
+        std::pair<file_id_type, bool> add(std::unordered_map<path_type::string_type, file_id_type>& _ids, path_type&& _path, context_type _context, bool _found);
+
+        std::vector<Record> files;
+        // Indexed by the context
+        std::vector<ContextIds> contexts;
+        std::unordered_map<path_type::string_type, file_id_type> missingIds;
+        // The first identifier of each found file, whatever context it was interned within
+        std::unordered_map<path_type::string_type, file_id_type> primaryIds;
+    };
+
+}
@@ -0,0 +1,252 @@
+#include "Utils.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace {
+
+    using path_type = typename std::filesystem::path;
+
+    constexpr std::string_view usage{
+        "Usage: dinclude_gen OUTPUT_DIR [--files=N] [--fan-out=N] [--depth=N] [--include-dirs=N] [--cycles=P] [--noise=P] [--file-size=BYTES] [--seed=N]\n"
+        "Generates a synthetic source tree in OUTPUT_DIR/src and OUTPUT_DIR/include. OUTPUT_DIR must be missing, empty or generated before,\n"
+        "the previously generated tree is replaced\n"
+    };
+
+    // Marks the directories created by the generator, only those are overwritten
+    constexpr std::string_view markerName{ ".dinclude_gen" };
+
+    struct TreeParameters {
+        // Total number of files, including the source files
+        unsigned files = 1000;
+        // Number of includes each file makes to the next level
+        unsigned fanOut = 4;
+        // Number of header levels below the source files
+        unsigned depth = 4;
+        unsigned includeDirectories = 4;
+        // Percentage of includes, which lead back to a shallower level and thus may close a cycle
+        unsigned cycles = 0;
+        // Percentage of includes, which are surrounded with comments and string literals containing fake directives
+        unsigned noise = 10;
+        // Approximate size of each file in bytes, the includes alone are used if the size is smaller
+        unsigned fileSize = 2048;
+        unsigned seed = 1;
+    };
+
+    struct GeneratedFile {
+        // Relative to the tree root
+        path_type path;
+        // The spelling to include the file with, empty for the source files
+        std::string spelling;
+        bool systemInclude;
+    };
+
+    /**
+     * @brief Places the files on the levels: the source files make the level 0, the headers are spread over the rest.
+     * A half of the headers lives next to the sources (included with quotes), the other half is spread over the include directories
+    */
+    std::vector<std::vector<GeneratedFile>> layoutFiles(const TreeParameters& _parameters) {
+        constexpr auto sourceDirectories = 8u;
+
+        std::vector<std::vector<GeneratedFile>> levels(_parameters.depth + 1);
+        for(auto i = 0u; i < _parameters.files; ++i) {
+            const auto level = i % (_parameters.depth + 1);
+            // Index of the file within its level
+            const auto index = i / (_parameters.depth + 1);
+            const auto directory = "module" + std::to_string(index % sourceDirectories);
+            if(!level) {
+                levels[level].push_back(GeneratedFile{ path_type{ "src" } / directory / ("unit" + std::to_string(i) + ".cpp"), std::string{}, false });
+            } else if(index % 2 || !_parameters.includeDirectories) {
+                const auto spelling = directory + "/header" + std::to_string(i) + ".hpp";
+                levels[level].push_back(GeneratedFile{ path_type{ "src" } / spelling, spelling, false });
+            } else {
+                const auto includeDirectory = "dir" + std::to_string(index / 2 % _parameters.includeDirectories);
+                const auto spelling = "lib" + std::to_string(level) + "/header" + std::to_string(i) + ".hpp";
+                levels[level].push_back(GeneratedFile{ path_type{ "include" } / includeDirectory / spelling, spelling, true });
+            }
+        }
+
+        return levels;
+    }
+
+    void writeNoise(std::ofstream& _ofs, std::mt19937& _random) {
+        switch(_random() % 4) {
+            case 0:
+                _ofs << "// #include \"commented_out.hpp\"\n";
+                break;
+            case 1:
+                _ofs << "/* Disabled for now:\n#include <commented_out.hpp>\n*/\n";
+                break;
+            case 2:
+                _ofs << "static const char* rawNoise = R\"noise(\n#include \"raw_string.hpp\"\n)noise\";\n";
+                break;
+            default:
+                _ofs << "static const char* stringNoise = \"#include <string_literal.hpp>\";\n";
+                break;
+        }
+    }
+
+    void writeFiller(std::ofstream& _ofs, std::size_t _bytes, unsigned _fileIndex) {
+        for(auto function = 0u; static_cast<std::size_t>(_ofs.tellp()) < _bytes; ++function) {
+            _ofs << "\ninline int function" << _fileIndex << "_" << function << "(int value) {\n"
+                 << "    // Filler to reach the requested file size\n"
+                 << "    return value * " << function + 1 << " + " << _fileIndex << ";\n"
+                 << "}\n";
+        }
+    }
+
+    /**
+     * @brief Makes sure the generated tree may be written into the directory and marks it as generated
+     * @throw `std::invalid_argument` if the directory has the other content, which would be overwritten
+    */
+    void prepareRoot(const path_type& _root) {
+        if(std::filesystem::exists(_root)) {
+            if(!std::filesystem::is_directory(_root)) {
+                throw std::invalid_argument{ "The output path is not a directory: \"" + _root.string() + "\"" };
+            } else if(!std::filesystem::is_empty(_root) && !std::filesystem::exists(_root / markerName)) {
+                throw std::invalid_argument{ "The output directory is neither empty, nor generated before, refusing to overwrite it: \"" + _root.string() + "\"" };
+            }
+        }
+
+        std::filesystem::create_directories(_root);
+        std::ofstream marker;
+        marker.exceptions(marker.exceptions() | std::ios::failbit | std::ios::badbit);
+        marker.open(_root / markerName, std::ios::binary | std::ios::trunc);
+        marker << "Generated by dinclude_gen, the content is replaced by the next run\n";
+    }
+
+    void generateTree(const path_type& _root, const TreeParameters& _parameters) {
+        std::mt19937 random{ _parameters.seed };
+        const auto levels = layoutFiles(_parameters);
+        // Every include directory exists, even if no header ended up in it
+        for(auto i = 0u; i < _parameters.includeDirectories; ++i) {
+            std::filesystem::create_directories(_root / "include" / ("dir" + std::to_string(i)));
+        }
+
+        auto fileIndex = 0u;
+        for(std::size_t level = 0; level < levels.size(); ++level) {
+            for(const auto& file : levels[level]) {
+                const auto filePath = _root / file.path;
+                std::filesystem::create_directories(filePath.parent_path());
+                std::ofstream ofs;
+                ofs.exceptions(ofs.exceptions() | std::ios::failbit | std::ios::badbit);
+                ofs.open(filePath, std::ios::binary | std::ios::trunc);
+
+                if(level) {
+                    ofs << "#pragma once\n";
+                }
+
+                const auto hasNextLevel = level + 1 < levels.size() && !levels[level + 1].empty();
+                for(auto include = 0u; include < _parameters.fanOut; ++include) {
+                    const GeneratedFile* target = nullptr;
+                    if(level && random() % 100 < _parameters.cycles) {
+                        const auto& targetLevel = levels[1 + random() % level];
+                        target = targetLevel.empty() ? nullptr : &targetLevel[random() % targetLevel.size()];
+                    } else if(hasNextLevel) {
+                        const auto& targetLevel = levels[level + 1];
+                        target = &targetLevel[random() % targetLevel.size()];
+                    }
+                    if(!target) {
+                        continue;
+                    }
+
+                    const auto noisy = random() % 100 < _parameters.noise;
+                    if(noisy) {
+                        writeNoise(ofs, random);
+                    }
+                    if(target->systemInclude) {
+                        ofs << "#include <" << target->spelling << ">\n";
+                    } else {
+                        ofs << "#include \"" << target->spelling << "\"\n";
+                    }
+                }
+
+                writeFiller(ofs, _parameters.fileSize, fileIndex++);
+            }
+        }
+    }
+
+}
+
+/**
+ * @brief Generates a synthetic source tree to measure `dinclude` with. The source files end up in `OUTPUT_DIR/src`, the headers
+ * are spread over it and `OUTPUT_DIR/include/dir*`. The generation is deterministic for the same parameters
+*/
+int main(int argc, char* argv[]) {
+
+    for(auto i = 1; i < argc; ++i) {
+        const std::string_view argument{ argv[i] };
+        if(argument == "--help" || argument == "-h") {
+            std::cout << usage;
+            return EXIT_SUCCESS;
+        }
+    }
+    if(argc < 2 || argv[1][0] == '-') {
+        // The output directory is wiped, so an option must not be taken for it
+        std::cerr << usage;
+        return EXIT_FAILURE;
+    }
+
+    try {
+        const auto arguments = tdw::utils::readArguments(argc, argv, tdw::utils::argument_set_type{
+            { "", "files", true },
+            { "", "fan-out", true },
+            { "", "depth", true },
+            { "", "include-dirs", true },
+            { "", "cycles", true },
+            { "", "noise", true },
+            { "", "file-size", true },
+            { "", "seed", true }
+        });
+        tdw::utils::assertCompliantArguments(arguments);
+
+        auto argIterator = arguments.cbegin();
+        const path_type root{ std::get<std::string>(*argIterator++) };
+
+        TreeParameters parameters;
+        for(; argIterator != arguments.cend(); ++argIterator) {
+            const auto& optionArgument = std::get<tdw::utils::option_type>(*argIterator);
+            const auto& name = optionArgument.first.longVersion;
+            if(name == "files") {
+                parameters.files = tdw::utils::positiveNumberArgument(optionArgument);
+            } else if(name == "fan-out") {
+                parameters.fanOut = tdw::utils::numberArgument(optionArgument);
+            } else if(name == "depth") {
+                parameters.depth = tdw::utils::numberArgument(optionArgument);
+            } else if(name == "include-dirs") {
+                parameters.includeDirectories = tdw::utils::numberArgument(optionArgument);
+            } else if(name == "cycles") {
+                parameters.cycles = std::min(tdw::utils::numberArgument(optionArgument), 100u);
+            } else if(name == "noise") {
+                parameters.noise = std::min(tdw::utils::numberArgument(optionArgument), 100u);
+            } else if(name == "file-size") {
+                parameters.fileSize = tdw::utils::numberArgument(optionArgument);
+            } else if(name == "seed") {
+                parameters.seed = tdw::utils::numberArgument(optionArgument);
+            }
+        }
+
+        prepareRoot(root);
+        std::filesystem::remove_all(root / "src");
+        std::filesystem::remove_all(root / "include");
+        generateTree(root, parameters);
+
+        // The quoted includes name the headers relative to "src", which is found through the include directories
+        std::cout << "dinclude " << (root / "src") << " -I " << (root / "src");
+        for(auto i = 0u; i < parameters.includeDirectories; ++i) {
+            std::cout << " -I " << (root / "include" / ("dir" + std::to_string(i)));
+        }
+        std::cout << std::endl;
+    } catch(const std::exception& exc) {
+        std::cerr << std::endl << exc.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,244 @@
+#include "GraphExporter.hpp"
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+
+namespace {
+
+    template<typename Integer>
+    void writeBinary(tdw::OutputWriter& _output, Integer _value) {
+        char bytes[sizeof(Integer)];
+        std::memcpy(bytes, &_value, sizeof(Integer));
+        _output.write(std::string_view{ bytes, sizeof(Integer) });
+    }
+
+    void writeBinaryString(tdw::OutputWriter& _output, std::string_view _value) {
+        writeBinary(_output, static_cast<std::uint32_t>(_value.size()));
+        _output.write(_value);
+    }
+
+}
+
+#pragma region Static
+tdw::GraphExporter::Format tdw::GraphExporter::format(std::string_view _name) {
+    if(_name == "json") {
+        return Format::json;
+    } else if(_name == "dot") {
+        return Format::dot;
+    } else if(_name == "edges") {
+        return Format::edges;
+    }
+    throw std::invalid_argument{ "Unknown output format: \"" + std::string{ _name } + "\"" };
+}
+
+std::string_view tdw::GraphExporter::typeName(Include::Type _type) {
+    switch(_type) {
+        case Include::Type::q_char:
+            return "q_char";
+        case Include::Type::h_char:
+            return "h_char";
+        default:
+            return "pp_tokens";
+    }
+}
+
+void tdw::GraphExporter::writeJsonString(OutputWriter& _output, std::string_view _text) {
+    constexpr std::string_view hexDigits{ "0123456789abcdef" };
+
+    _output.write('"');
+    for(const auto character : _text) {
+        const auto code = static_cast<unsigned char>(character);
+        if(character == '"' || character == '\\') {
+            _output.write('\\');
+            _output.write(character);
+        } else if(code < 0x20) {
+            _output.write("\\u00");
+            _output.write(hexDigits[code >> 4]);
+            _output.write(hexDigits[code & 0xF]);
+        } else {
+            _output.write(character);
+        }
+    }
+    _output.write('"');
+}
+
+void tdw::GraphExporter::writeDotString(OutputWriter& _output, std::string_view _text) {
+    // Backslashes are escaped too, otherwise Graphviz treats them as label escapes
+    std::string quoted;
+    OutputWriter::appendQuoted(quoted, _text);
+    _output.write(quoted);
+}
+#pragma endregion
+
+#pragma region Lifecycle
+tdw::GraphExporter::GraphExporter(const IncludeGraph& _graph, const std::vector<IncludeGraph::node_id_type>& _roots)
+    : graph{ _graph }, indices(_graph.size()), roots(_graph.size()), components(_graph.size()) {
+    const auto& files = graph.files();
+    nodes.resize(graph.size());
+    for(IncludeGraph::node_id_type node = 0; node < graph.size(); ++node) {
+        nodes[node] = node;
+    }
+    // Found files go first, the missing ones are known by the spelling only
+    std::sort(nodes.begin(), nodes.end(), [&files](IncludeGraph::node_id_type _left, IncludeGraph::node_id_type _right) {
+        if(files.found(_left) != files.found(_right)) {
+            return files.found(_left);
+        }
+        return files.path(_left) < files.path(_right);
+    });
+    for(std::size_t i = 0; i < nodes.size(); ++i) {
+        indices[nodes[i]] = static_cast<std::uint32_t>(i);
+    }
+
+    for(const auto root : _roots) {
+        roots[root] = true;
+    }
+
+    const auto graphComponents = graph.components();
+    for(std::size_t i = 0; i < graphComponents.size(); ++i) {
+        for(const auto node : graphComponents[i]) {
+            components[node] = i;
+        }
+    }
+}
+#pragma endregion
+
+#pragma region Actions
+void tdw::GraphExporter::write(Format _format, OutputWriter& _output) const {
+    switch(_format) {
+        case Format::json:
+            writeJson(_output);
+            break;
+        case Format::dot:
+            writeDot(_output);
+            break;
+        case Format::edges:
+            writeEdges(_output);
+            break;
+    }
+}
+
+void tdw::GraphExporter::writeJson(OutputWriter& _output) const {
+    const auto& files = graph.files();
+
+    _output.write("{\n\"nodes\": [");
+    for(std::size_t i = 0; i < nodes.size(); ++i) {
+        const auto node = nodes[i];
+        _output.write(i ? ",\n{\"id\": " : "\n{\"id\": ");
+        _output.write(static_cast<std::uint64_t>(i));
+        _output.write(", \"path\": ");
+        writeJsonString(_output, files.path(node).string());
+        _output.write(", \"display\": ");
+        writeJsonString(_output, files.displayPath(node).string());
+        _output.write(files.found(node) ? ", \"found\": true" : ", \"found\": false");
+        _output.write(roots[node] ? ", \"root\": true}" : ", \"root\": false}");
+    }
+
+    _output.write("\n],\n\"edges\": [");
+    auto firstEdge = true;
+    for(const auto node : nodes) {
+        for(const auto& edge : graph.node(node).edges) {
+            _output.write(firstEdge ? "\n{\"source\": " : ",\n{\"source\": ");
+            firstEdge = false;
+            _output.write(static_cast<std::uint64_t>(indices[node]));
+            _output.write(", \"target\": ");
+            _output.write(static_cast<std::uint64_t>(indices[edge.target]));
+            _output.write(", \"include\": ");
+            writeJsonString(_output, edge.spellingPath().string());
+            _output.write(", \"type\": \"");
+            _output.write(typeName(edge.type));
+            _output.write("\", \"directory\": ");
+            writeJsonString(_output, edge.parentDirectory().string());
+            _output.write(files.found(edge.target) ? ", \"notFound\": false" : ", \"notFound\": true");
+            _output.write(components[node] == components[edge.target] ? ", \"cycle\": true}" : ", \"cycle\": false}");
+        }
+    }
+    _output.write("\n]\n}\n");
+}
+
+void tdw::GraphExporter::writeDot(OutputWriter& _output) const {
+    const auto& files = graph.files();
+
+    _output.write("digraph includes {\n");
+    for(std::size_t i = 0; i < nodes.size(); ++i) {
+        const auto node = nodes[i];
+        _output.write("    n");
+        _output.write(static_cast<std::uint64_t>(i));
+        _output.write(" [label=");
+        writeDotString(_output, files.displayPath(node).string());
+        _output.write(", tooltip=");
+        writeDotString(_output, files.path(node).string());
+        if(!files.found(node)) {
+            _output.write(", style=dashed");
+        } else if(roots[node]) {
+            _output.write(", shape=box");
+        }
+        _output.write("];\n");
+    }
+
+    for(const auto node : nodes) {
+        for(const auto& edge : graph.node(node).edges) {
+            const auto cycle = components[node] == components[edge.target];
+            _output.write("    n");
+            _output.write(static_cast<std::uint64_t>(indices[node]));
+            _output.write(" -> n");
+            _output.write(static_cast<std::uint64_t>(indices[edge.target]));
+            _output.write(" [include=");
+            writeDotString(_output, edge.spellingPath().string());
+            _output.write(", type=");
+            _output.write(typeName(edge.type));
+            _output.write(", directory=");
+            writeDotString(_output, edge.parentDirectory().string());
+            _output.write(files.found(edge.target) ? ", not_found=false" : ", not_found=true, style=dashed");
+            _output.write(cycle ? ", cycle=true, color=red];\n" : ", cycle=false];\n");
+        }
+    }
+    _output.write("}\n");
+}
+
+void tdw::GraphExporter::writeEdges(OutputWriter& _output) const {
+    const auto& files = graph.files();
+
+    // Resolution directories repeat a lot, so the edges refer to them by index
+    std::map<std::string, std::uint32_t> directories;
+    std::uint64_t edgesCount = 0;
+    for(const auto node : nodes) {
+        for(const auto& edge : graph.node(node).edges) {
+            directories.emplace(edge.parentDirectory().string(), 0);
+            ++edgesCount;
+        }
+    }
+    std::uint32_t directoryIndex = 0;
+    for(auto& directory : directories) {
+        directory.second = directoryIndex++;
+    }
+
+    _output.write(edgesMagic);
+    writeBinary(_output, edgesVersion);
+
+    writeBinary(_output, static_cast<std::uint32_t>(nodes.size()));
+    for(const auto node : nodes) {
+        writeBinary(_output, static_cast<std::uint8_t>((files.found(node) ? 0 : nodeNotFoundFlag) | (roots[node] ? nodeRootFlag : 0)));
+        writeBinaryString(_output, files.path(node).string());
+        writeBinaryString(_output, files.displayPath(node).string());
+    }
+
+    writeBinary(_output, static_cast<std::uint32_t>(directories.size()));
+    for(const auto& directory : directories) {
+        writeBinaryString(_output, directory.first);
+    }
+
+    writeBinary(_output, edgesCount);
+    for(const auto node : nodes) {
+        for(const auto& edge : graph.node(node).edges) {
+            const auto cycle = components[node] == components[edge.target];
+            writeBinary(_output, indices[node]);
+            writeBinary(_output, indices[edge.target]);
+            writeBinary(_output, static_cast<std::uint8_t>(edge.type));
+            writeBinary(_output, static_cast<std::uint8_t>((files.found(edge.target) ? 0 : edgeNotFoundFlag) | (cycle ? edgeCycleFlag : 0)));
+            writeBinary(_output, directories.at(edge.parentDirectory().string()));
+            writeBinaryString(_output, edge.spellingPath().string());
+        }
+    }
+}
+#pragma endregion
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "IncludeGraph.hpp"
+#include "OutputWriter.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tdw {
+
+    /**
+     * @brief Serializes the include graph itself (rather than the tree of include chains), so the output size depends on the
+     * number of files and includes only. Nodes and edges are streamed straight to the output.
+     * Nodes are numbered in the order of their paths, so the result doesn't depend on the order the files were read in.
+     * Each edge keeps the include spelling and type, the directory it was resolved in and whether it was not found or lies on
+     * a cycle (i.e. both files belong to the same strongly connected component)
+    */
+    class GraphExporter {
+    public:
+        enum class Format {
+            json,
+            dot,
+            // Compact binary edge list
+            edges
+        };
+
+        /**
+         * @throw `std::invalid_argument` if the name doesn't match any format
+        */
+        static Format format(std::string_view _name);
+
+        GraphExporter(const IncludeGraph& _graph, const std::vector<IncludeGraph::node_id_type>& _roots);
+
+        void write(Format _format, OutputWriter& _output) const;
+
+    private:
+        static constexpr std::string_view edgesMagic{ "DINCEDGE" };
+        static constexpr std::uint32_t edgesVersion = 1;
+        // Bits of the node record flags in the `edges` format
+        static constexpr std::uint8_t nodeNotFoundFlag = 1;
+        static constexpr std::uint8_t nodeRootFlag = 2;
+        // Bits of the edge record flags in the `edges` format, they describe the target of the edge
+        static constexpr std::uint8_t edgeNotFoundFlag = 1;
+        static constexpr std::uint8_t edgeCycleFlag = 2;
+
+        static std::string_view typeName(Include::Type _type);
+        /**
+         * @brief Writes the text as a JSON string literal
+        */
+        static void writeJsonString(OutputWriter& _output, std::string_view _text);
+        /**
+         * @brief Writes the text as a DOT quoted string
+        */
+        static void writeDotString(OutputWriter& _output, std::string_view _text);
+
+        void writeJson(OutputWriter& _output) const;
+        void writeDot(OutputWriter& _output) const;
+        void writeEdges(OutputWriter& _output) const;
+
+        const IncludeGraph& graph;
+        // Nodes in the exported order
+        std::vector<IncludeGraph::node_id_type> nodes;
+        // Exported index of each node, indexed by `IncludeGraph::node_id_type`
+        std::vector<std::uint32_t> indices;
+        std::vector<bool> roots;
+        // Strongly connected component of each node, indexed by `IncludeGraph::node_id_type`
+        std::vector<std::size_t> components;
+    };
+
+}
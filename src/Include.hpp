@@ -0,0 +1,35 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+
+namespace tdw {
+
+    struct Include {
+        using path_type = typename std::filesystem::path;
+
+        enum class Type {
+            q_char, h_char, pp_tokens
+        };
+
+        const path_type path;
+        const Type type;
+
+        Include(const path_type& _path, Type _type) : path{ _path }, type{ _type } {}
+
+        struct HashFunction {
+            size_t operator()(const Include& _include) const {
+                const auto pathHash = std::hash<path_type::string_type>()(_include.path.native());
+                const auto typeHash = std::hash<Type>()(_include.type) << 1;
+                return pathHash ^ typeHash;
+            }
+        };
+
+        struct EqualTo {
+            bool operator()(const Include& _left, const Include& _right) const {
+                return (_left.path == _right.path) && (_left.type == _right.type);
+            }
+        };
+    };
+
+}
@@ -0,0 +1,68 @@
+#include "IncludeGraph.hpp"
+#include <algorithm>
+#include <limits>
+
+#pragma region Actions
+std::vector<std::vector<tdw::IncludeGraph::node_id_type>> tdw::IncludeGraph::components() const {
+    constexpr auto unvisited = std::numeric_limits<node_id_type>::max();
+
+    std::vector<std::vector<node_id_type>> result;
+    // Order the nodes were visited in, and the lowest order reachable from the node through the nodes on the stack
+    std::vector<node_id_type> order(nodes.size(), unvisited);
+    std::vector<node_id_type> lowLink(nodes.size());
+    std::vector<bool> onStack(nodes.size());
+    std::vector<node_id_type> componentStack;
+    // Explicit DFS stack, so long include chains don't exhaust the call stack
+    std::vector<std::pair<node_id_type, std::size_t>> dfsStack;
+    node_id_type nextOrder = 0;
+
+    for(node_id_type root = 0; root < size(); ++root) {
+        if(order[root] != unvisited) {
+            continue;
+        }
+
+        order[root] = lowLink[root] = nextOrder++;
+        componentStack.push_back(root);
+        onStack[root] = true;
+        dfsStack.emplace_back(root, 0);
+        while(!dfsStack.empty()) {
+            auto& [node, edgeIndex] = dfsStack.back();
+            const auto& edges = nodes[node].edges;
+            if(edgeIndex < edges.size()) {
+                const auto target = edges[edgeIndex++].target;
+                if(order[target] == unvisited) {
+                    order[target] = lowLink[target] = nextOrder++;
+                    componentStack.push_back(target);
+                    onStack[target] = true;
+                    dfsStack.emplace_back(target, 0);
+                } else if(onStack[target]) {
+                    lowLink[node] = std::min(lowLink[node], order[target]);
+                }
+                continue;
+            }
+
+            const auto finished = node;
+            dfsStack.pop_back();
+            if(!dfsStack.empty()) {
+                auto& parent = dfsStack.back().first;
+                lowLink[parent] = std::min(lowLink[parent], lowLink[finished]);
+            }
+
+            if(lowLink[finished] == order[finished]) {
+                auto& component = result.emplace_back();
+                node_id_type member;
+                do {
+                    member = componentStack.back();
+                    componentStack.pop_back();
+                    onStack[member] = false;
+                    component.push_back(member);
+                } while(member != finished);
+            }
+        }
+    }
+
+    // Tarjan's algorithm completes the components in reverse topological order
+    std::reverse(result.begin(), result.end());
+    return result;
+}
+#pragma endregion
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "FileTable.hpp"
+#include "Include.hpp"
+#include "StringPool.hpp"
+#include <filesystem>
+#include <utility>
+#include <vector>
+
+namespace tdw {
+
+    /**
+     * @brief In-memory include graph. Every file (found or not) is represented by exactly one node per search context, identified by
+     * its `FileTable` identifier, which keeps the `#include` directives found in the file as outgoing edges. The graph is built once per run, so any
+     * traversal over it (tree printing, counting) doesn't touch the file system anymore
+    */
+    class IncludeGraph {
+    public:
+        using path_type = typename std::filesystem::path;
+        using node_id_type = typename FileTable::file_id_type;
+        using context_type = typename FileTable::context_type;
+
+        /**
+         * @brief Plain record of an include: the strings are views of the graph's `strings()`, so the edges own no memory
+        */
+        struct Edge {
+            StringPool::view_type spelling;
+            Include::Type type;
+            // The directory the include was found in, empty if the search failed
+            StringPool::view_type parentPath;
+            // Refers to a missing file node if the search failed
+            node_id_type target;
+
+            Include include() const {
+                return Include{ path_type{ spelling }, type };
+            }
+
+            path_type spellingPath() const {
+                return path_type{ spelling };
+            }
+
+            path_type parentDirectory() const {
+                return path_type{ parentPath };
+            }
+        };
+
+        struct Node {
+            std::vector<Edge> edges;
+            // Whether the file was read, the edges are meaningless otherwise
+            bool scanned = false;
+            // Whether the file is protected from being included twice, only known when the conditional directives are evaluated
+            bool guarded = false;
+        };
+
+        /**
+         * @brief Looks up the node for the given file within the search context and creates one if it doesn't exist yet
+         * @return id of the node and `true` if the node was created by the call
+        */
+        std::pair<node_id_type, bool> addNode(const path_type& _filePath, context_type _context = 0) {
+            return fitNodes(fileTable.intern(_filePath, _context));
+        }
+
+        /**
+         * @brief Same as `addNode`, but the given path must be (weakly) canonical already
+        */
+        std::pair<node_id_type, bool> addCanonicalNode(const path_type& _filePath, context_type _context = 0) {
+            return fitNodes(fileTable.internCanonical(_filePath, _context));
+        }
+
+        /**
+         * @brief Looks up the node for the include spelling, which could not be found, and creates one if it doesn't exist yet
+         * @return id of the node and `true` if the node was created by the call
+        */
+        std::pair<node_id_type, bool> addMissingNode(const path_type& _spelling) {
+            return fitNodes(fileTable.internMissing(_spelling));
+        }
+
+        const Node& node(node_id_type _id) const {
+            return nodes[_id];
+        }
+
+        Node& node(node_id_type _id) {
+            return nodes[_id];
+        }
+
+        const FileTable& files() const {
+            return fileTable;
+        }
+
+        FileTable& files() {
+            return fileTable;
+        }
+
+        /**
+         * @brief Storage of the edge strings, the spellings and the directories repeat a lot, so each of them is stored once
+        */
+        StringPool& strings() {
+            return stringPool;
+        }
+
+        node_id_type size() const {
+            return static_cast<node_id_type>(nodes.size());
+        }
+
+        /**
+         * @brief Splits the graph into strongly connected components (Tarjan's algorithm), i.e. the groups of files which include
+         * each other through a cycle. Runs in linear time of the nodes and edges number
+         * @return the components in topological order: no component has an edge to any of the components before it
+        */
+        std::vector<std::vector<node_id_type>> components() const;
+
+    private:
+        std::pair<node_id_type, bool> fitNodes(std::pair<node_id_type, bool> _file) {
+            if(_file.second) {
+                nodes.resize(fileTable.size());
+            }
+            return _file;
+        }
+
+        FileTable fileTable;
+        std::vector<Node> nodes;
+        StringPool stringPool;
+    };
+
+}
@@ -0,0 +1,131 @@
+#include "IncludeResolver.hpp"
+#include <algorithm>
+#include <system_error>
+
+#if defined(_WIN32) || defined(__APPLE__)
+// The file systems are case-insensitive by default, so a file may be named differently than its listing entry
+#define TDW_INCLUDE_RESOLVER_CASE_INSENSITIVE 1
+#endif
+
+#pragma region Actions
+tdw::IncludeResolver::context_type tdw::IncludeResolver::addContext(SearchPaths&& _searchPaths) {
+    // There are only a handful of distinct sets of the flags in practice, even for thousands of translation units
+    const auto it = std::find(contexts.cbegin(), contexts.cend(), _searchPaths);
+    if(it != contexts.cend()) {
+        return static_cast<context_type>(it - contexts.cbegin());
+    }
+    contexts.push_back(std::move(_searchPaths));
+    return static_cast<context_type>(contexts.size() - 1);
+}
+
+const tdw::IncludeResolver::Resolution& tdw::IncludeResolver::resolve(const Include& _include, const path_type& _currentPath, context_type _context) {
+    LookupKey key{
+        _include.path.native(),
+        _include.type == Include::Type::h_char ? path_type::string_type{} : _currentPath.native(),
+        _include.type,
+        _context
+    };
+
+    {
+        std::lock_guard lock{ mutex };
+        const auto it = lookups.find(key);
+        if(it != lookups.cend()) {
+            ++stats.lookupHits;
+            return it->second;
+        }
+        ++stats.lookupMisses;
+    }
+
+    // Concurrent searches of the same include end up with the same result, the first one is kept
+    auto resolution = search(_include, _currentPath, contexts[_context]);
+    std::lock_guard lock{ mutex };
+    return lookups.emplace(std::move(key), std::move(resolution)).first->second;
+}
+#pragma endregion
+
+#pragma region Search
+tdw::IncludeResolver::Resolution tdw::IncludeResolver::search(const Include& _include, const path_type& _currentPath, const SearchPaths& _searchPaths) {
+    // Follows C standard "6.10.2 Source file inclusion" - http://www.open-std.org/jtc1/sc22/wg14/www/docs/n1570.pdf#page=182
+    if(_include.type == Include::Type::pp_tokens) {
+        // The tokens didn't expand into a header name
+        return Resolution{};
+    } else if(_include.type == Include::Type::q_char) {
+        const auto searchPath = _currentPath / _include.path;
+        if(isRegularFile(searchPath)) {
+            return Resolution{ _currentPath, canonical(searchPath) };
+        }
+
+        for(const auto& quotePath : _searchPaths.quotePaths) {
+            const auto quoteSearchPath = quotePath / _include.path;
+            if(isRegularFile(quoteSearchPath)) {
+                return Resolution{ quotePath, canonical(quoteSearchPath) };
+            }
+        }
+    }
+
+    for(const auto& includePath : _searchPaths.includePaths) {
+        const auto searchPath = includePath / _include.path;
+        if(isRegularFile(searchPath)) {
+            return Resolution{ includePath, canonical(searchPath) };
+        }
+    }
+
+    return Resolution{};
+}
+
+tdw::IncludeResolver::path_type tdw::IncludeResolver::canonical(const path_type& _filePath) {
+    {
+        std::lock_guard lock{ mutex };
+        ++stats.canonicalizations;
+    }
+    return std::filesystem::weakly_canonical(_filePath);
+}
+
+bool tdw::IncludeResolver::isRegularFile(const path_type& _filePath) {
+    if(isListed(_filePath)) {
+        return true;
+    }
+#ifdef TDW_INCLUDE_RESOLVER_CASE_INSENSITIVE
+    std::error_code errorCode;
+    return std::filesystem::is_regular_file(_filePath, errorCode);
+#else
+    return false;
+#endif
+}
+
+bool tdw::IncludeResolver::isListed(const path_type& _filePath) {
+    using namespace std::filesystem;
+
+    const auto fileName = _filePath.filename();
+    const auto directoryPath = _filePath.parent_path();
+    {
+        std::lock_guard lock{ mutex };
+        ++stats.probes;
+        if(fileName.empty() || fileName == "." || fileName == "..") {
+            return false;
+        }
+
+        const auto it = directoryListings.find(directoryPath.native());
+        if(it != directoryListings.cend()) {
+            return it->second.count(fileName.native()) != 0;
+        }
+    }
+
+    // A missing directory just ends up with an empty listing
+    directory_listing_type listing;
+    std::error_code errorCode;
+    for(directory_iterator entries{ directoryPath.empty() ? path_type{ "." } : directoryPath, errorCode }, end; !errorCode && entries != end; entries.increment(errorCode)) {
+        std::error_code typeErrorCode;
+        if(entries->is_regular_file(typeErrorCode)) {
+            listing.insert(entries->path().filename().native());
+        }
+    }
+
+    std::lock_guard lock{ mutex };
+    const auto [it, inserted] = directoryListings.try_emplace(directoryPath.native(), std::move(listing));
+    if(inserted) {
+        ++stats.directoryListings;
+    }
+    return it->second.count(fileName.native()) != 0;
+}
+#pragma endregion
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "Include.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace tdw {
+
+    /**
+     * @brief Resolves includes against the current directory and the include directories. Each directory touched by the search
+     * is listed only once, and the result of every `(spelling, current directory, type)` lookup is memoized, thus repeated
+     * includes cost a hash lookup instead of a `stat` call per include directory. The resolver is safe to use from multiple threads.
+     * Several sets of include directories (search contexts) may be used at once, e.g. one per distinct set of compiler flags. Each of
+     * them memoizes its own lookups, while the directory listings are shared.
+    */
+    class IncludeResolver {
+    public:
+        using path_type = typename std::filesystem::path;
+        using context_type = typename std::uint32_t;
+
+        struct SearchPaths {
+            // Searched for the `q_char` includes only, after the directory of the file (`-iquote`)
+            std::vector<path_type> quotePaths;
+            // Searched for all the includes, in order (`-I`, then `-isystem`)
+            std::vector<path_type> includePaths;
+
+            bool operator==(const SearchPaths& _other) const {
+                return quotePaths == _other.quotePaths && includePaths == _other.includePaths;
+            }
+        };
+
+        struct Statistics {
+            std::size_t lookupHits = 0;
+            std::size_t lookupMisses = 0;
+            std::size_t probes = 0;
+            std::size_t directoryListings = 0;
+            // Calls of `std::filesystem::weakly_canonical` for the found files
+            std::size_t canonicalizations = 0;
+        };
+
+        struct Resolution {
+            // The directory the include was found in, empty if the search failed
+            path_type parentPath;
+            // (Weakly) canonical path to the found file, empty if the search failed
+            path_type filePath;
+        };
+
+        /**
+         * @param _includePaths - include directories of the default context
+        */
+        explicit IncludeResolver(const std::vector<path_type>& _includePaths) : contexts{ SearchPaths{ {}, _includePaths } } {}
+
+        /**
+         * @brief Adds the search context, unless the same one was added already. Must not run concurrently with `resolve`
+         * @return the context to resolve the includes within
+        */
+        context_type addContext(SearchPaths&& _searchPaths);
+
+        /**
+         * @param _include - the include statement
+         * @param _currentPath - the directory of the file the include statement belongs to
+         * @param _context - the search context returned by `addContext`, the default one if zero
+         * @return the resolution, which stays valid for the lifetime of the resolver
+        */
+        const Resolution& resolve(const Include& _include, const path_type& _currentPath, context_type _context = 0);
+
+        /**
+         * @brief Forgets everything known about the file system, e.g. once files were added or removed.
+         * Invalidates the resolutions returned before
+        */
+        void clear() {
+            std::lock_guard lock{ mutex };
+            lookups.clear();
+            directoryListings.clear();
+        }
+
+        Statistics statistics() const {
+            std::lock_guard lock{ mutex };
+            return stats;
+        }
+
+    private:
+        struct LookupKey {
+            path_type::string_type spelling;
+            // Empty for `h_char` includes, since the current directory doesn't take part in the search
+            path_type::string_type currentPath;
+            Include::Type type;
+            context_type context;
+
+            struct HashFunction {
+                size_t operator()(const LookupKey& _key) const {
+                    const auto spellingHash = std::hash<path_type::string_type>()(_key.spelling);
+                    const auto currentPathHash = std::hash<path_type::string_type>()(_key.currentPath) << 1;
+                    const auto typeHash = std::hash<Include::Type>()(_key.type) << 2;
+                    const auto contextHash = std::hash<context_type>()(_key.context) << 3;
+                    return spellingHash ^ currentPathHash ^ typeHash ^ contextHash;
+                }
+            };
+
+            struct EqualTo {
+                bool operator()(const LookupKey& _left, const LookupKey& _right) const {
+                    return (_left.spelling == _right.spelling) && (_left.currentPath == _right.currentPath) && (_left.type == _right.type) &&
+                        (_left.context == _right.context);
+                }
+            };
+        };
+        using directory_listing_type = std::unordered_set<path_type::string_type>;
+
+        Resolution search(const Include& _include, const path_type& _currentPath, const SearchPaths& _searchPaths);
+        /**
+         * @brief Equivalent of `std::filesystem::is_regular_file`, which consults the listing of the file's directory instead.
+         * The file system is asked directly only if it ignores the case and the listing has no exact match
+        */
+        bool isRegularFile(const path_type& _filePath);
+        /**
+         * @return whether the listing of the file's directory has a regular file of exactly this name
+        */
+        bool isListed(const path_type& _filePath);
+        path_type canonical(const path_type& _filePath);
+
+        std::vector<SearchPaths> contexts;
+        // Guards the caches and the statistics. The file system is never accessed while it's locked
+        mutable std::mutex mutex;
+        std::unordered_map<LookupKey, Resolution, LookupKey::HashFunction, LookupKey::EqualTo> lookups;
+        std::unordered_map<path_type::string_type, directory_listing_type> directoryListings;
+        Statistics stats;
+    };
+
+}
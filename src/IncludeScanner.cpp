@@ -0,0 +1,516 @@
+#include "IncludeScanner.hpp"
+
+namespace {
+
+    inline bool isIdentifierStart(char _character) {
+        const auto character = static_cast<unsigned char>(_character);
+        // Non-ASCII characters are treated as parts of (universal character name) identifiers
+        return (character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z') || character == '_' || character >= 0x80;
+    }
+
+    inline bool isDigit(char _character) {
+        return _character >= '0' && _character <= '9';
+    }
+
+    inline bool isIdentifierCharacter(char _character) {
+        return isIdentifierStart(_character) || isDigit(_character);
+    }
+
+    inline bool isHorizontalSpace(char _character) {
+        return _character == ' ' || _character == '\t' || _character == '\r' || _character == '\v' || _character == '\f';
+    }
+
+    inline bool isRawStringPrefix(const std::string& _identifier) {
+        return _identifier == "R" || _identifier == "LR" || _identifier == "uR" || _identifier == "UR" || _identifier == "u8R";
+    }
+
+    inline bool isEncodingPrefix(const std::string& _identifier) {
+        return _identifier == "L" || _identifier == "u" || _identifier == "U" || _identifier == "u8";
+    }
+
+    std::string_view trim(std::string_view _text) {
+        while(!_text.empty() && isHorizontalSpace(_text.front())) {
+            _text.remove_prefix(1);
+        }
+        while(!_text.empty() && isHorizontalSpace(_text.back())) {
+            _text.remove_suffix(1);
+        }
+        return _text;
+    }
+
+    std::string_view leadingIdentifier(std::string_view _text) {
+        _text = trim(_text);
+        std::size_t length = 0;
+        if(!_text.empty() && isIdentifierStart(_text.front())) {
+            while(length < _text.size() && isIdentifierCharacter(_text[length])) {
+                ++length;
+            }
+        }
+        return _text.substr(0, length);
+    }
+
+    /**
+     * @return the macro, which the `#if` condition tests to be not defined (`!defined MACRO` or `!defined(MACRO)`), or an empty string
+    */
+    std::string guardCondition(std::string_view _expression) {
+        std::string condensed;
+        for(const auto character : _expression) {
+            if(!isHorizontalSpace(character)) {
+                condensed.push_back(character);
+            }
+        }
+
+        std::string_view condition{ condensed };
+        constexpr std::string_view prefix{ "!defined" };
+        if(condition.substr(0, prefix.size()) != prefix) {
+            return std::string{};
+        }
+        condition.remove_prefix(prefix.size());
+        if(!condition.empty() && condition.front() == '(' && condition.back() == ')') {
+            condition = condition.substr(1, condition.size() - 2);
+        }
+        return !condition.empty() && leadingIdentifier(condition) == condition ? std::string{ condition } : std::string{};
+    }
+
+}
+
+#pragma region Lifecycle
+tdw::IncludeScanner::IncludeScanner(std::string_view _source, bool _preambleOnly, const MacroTable* _macros)
+    : source{ _source }, preambleOnly{ _preambleOnly } {
+    if(_macros) {
+        macros.emplace(_macros);
+    }
+    // UTF-8 byte order mark
+    constexpr std::string_view bom{ "\xEF\xBB\xBF" };
+    if(source.substr(0, bom.size()) == bom) {
+        position = bom.size();
+    }
+    position = skipSplices(position);
+}
+#pragma endregion
+
+#pragma region Actions
+std::vector<tdw::Include> tdw::IncludeScanner::scan() {
+    std::vector<Include> includes;
+    // Only whitespaces and comments were met since the beginning of the line
+    auto lineStart = true;
+
+    while(!atEnd()) {
+        const auto character = current();
+
+        if(character == '\n') {
+            lineStart = true;
+            advance();
+        } else if(isHorizontalSpace(character)) {
+            advance();
+        } else if(character == '/' && lookahead() == '/') {
+            skipLineComment();
+        } else if(character == '/' && lookahead() == '*') {
+            // The comment is replaced with a space, so it doesn't affect `lineStart`
+            skipBlockComment();
+        } else if(lineStart && (character == '#' || (character == '%' && lookahead() == ':'))) {
+            scanDirective(includes);
+            lineStart = false;
+        } else if(lineStart && (preambleOnly || macros)) {
+            if(preambleOnly && !skipping()) {
+                // The first token of the code ends the preamble
+                break;
+            }
+            if(conditionals.empty()) {
+                // The code outside of the guard group
+                guard = GuardState::broken;
+            }
+            // The token is lexed as usual on the next iteration
+            lineStart = false;
+        } else if(character == '"' || character == '\'') {
+            skipQuoted(character);
+            lineStart = false;
+        } else if(isIdentifierStart(character)) {
+            const auto identifier = readIdentifier();
+            if(!atEnd() && current() == '"' && isRawStringPrefix(identifier)) {
+                skipRawString();
+            } else if(!atEnd() && (current() == '"' || current() == '\'') && isEncodingPrefix(identifier)) {
+                skipQuoted(current());
+            }
+            lineStart = false;
+        } else if(isDigit(character) || (character == '.' && isDigit(lookahead()))) {
+            // Numbers need to be skipped as a whole, since they may contain digit separators (`1'000`)
+            skipNumber();
+            lineStart = false;
+        } else {
+            advance();
+            lineStart = false;
+        }
+    }
+
+    return includes;
+}
+#pragma endregion
+
+#pragma region Lexing
+tdw::IncludeScanner::size_type tdw::IncludeScanner::skipSplices(size_type _position) const {
+    while(_position < source.size() && source[_position] == '\\') {
+        if(_position + 1 < source.size() && source[_position + 1] == '\n') {
+            _position += 2;
+        } else if(_position + 2 < source.size() && source[_position + 1] == '\r' && source[_position + 2] == '\n') {
+            _position += 3;
+        } else {
+            break;
+        }
+    }
+
+    return _position;
+}
+
+void tdw::IncludeScanner::skipLineComment() {
+    // The new line character is left for the caller, since it terminates the line
+    while(!atEnd() && current() != '\n') {
+        advance();
+    }
+}
+
+void tdw::IncludeScanner::skipBlockComment() {
+    advance();
+    advance();
+    while(!atEnd()) {
+        if(current() == '*' && lookahead() == '/') {
+            advance();
+            advance();
+            return;
+        }
+        advance();
+    }
+}
+
+void tdw::IncludeScanner::skipQuoted(char _delimiter) {
+    advance();
+    while(!atEnd()) {
+        const auto character = current();
+        if(character == _delimiter) {
+            advance();
+            return;
+        } else if(character == '\n') {
+            // Unterminated literal, it ends with the line
+            return;
+        } else if(character == '\\') {
+            advance();
+            if(atEnd() || current() == '\n') {
+                return;
+            }
+        }
+        advance();
+    }
+}
+
+void tdw::IncludeScanner::skipRawString() {
+    // Line splices are reverted within raw strings, so the content is read as is
+    constexpr auto maxDelimiterSize = static_cast<size_type>(16);
+    const auto delimiterBegin = position + 1;
+    auto delimiterEnd = delimiterBegin;
+    while(delimiterEnd < source.size() && source[delimiterEnd] != '(') {
+        const auto character = source[delimiterEnd];
+        if(delimiterEnd - delimiterBegin >= maxDelimiterSize || character == ')' || character == '\\' || character == '"' ||
+           character == '\n' || isHorizontalSpace(character)) {
+            // Not a valid raw string, fallback to the ordinary one
+            skipQuoted('"');
+            return;
+        }
+        ++delimiterEnd;
+    }
+
+    if(delimiterEnd >= source.size()) {
+        position = source.size();
+        return;
+    }
+
+    std::string terminator{ ")" };
+    terminator.append(source.substr(delimiterBegin, delimiterEnd - delimiterBegin));
+    terminator.push_back('"');
+
+    const auto terminatorPosition = source.find(terminator, delimiterEnd + 1);
+    if(terminatorPosition == std::string_view::npos) {
+        position = source.size();
+    } else {
+        position = skipSplices(terminatorPosition + terminator.size());
+    }
+}
+
+void tdw::IncludeScanner::skipNumber() {
+    advance();
+    while(!atEnd()) {
+        const auto character = current();
+        if((character == 'e' || character == 'E' || character == 'p' || character == 'P') && (lookahead() == '+' || lookahead() == '-')) {
+            advance();
+            advance();
+        } else if(isIdentifierCharacter(character) || character == '.') {
+            advance();
+        } else if(character == '\'' && isIdentifierCharacter(lookahead())) {
+            advance();
+            advance();
+        } else {
+            return;
+        }
+    }
+}
+
+void tdw::IncludeScanner::skipHorizontalSpace() {
+    while(!atEnd()) {
+        if(isHorizontalSpace(current())) {
+            advance();
+        } else if(current() == '/' && lookahead() == '*') {
+            skipBlockComment();
+        } else {
+            return;
+        }
+    }
+}
+
+std::string tdw::IncludeScanner::readIdentifier() {
+    std::string identifier;
+    while(!atEnd() && isIdentifierCharacter(current())) {
+        identifier.push_back(current());
+        advance();
+    }
+
+    return identifier;
+}
+
+std::string tdw::IncludeScanner::readLine() {
+    std::string line;
+    while(!atEnd() && current() != '\n') {
+        const auto character = current();
+        if(character == '/' && lookahead() == '/') {
+            skipLineComment();
+        } else if(character == '/' && lookahead() == '*') {
+            skipBlockComment();
+            line.push_back(' ');
+        } else if((character == '"' || character == '\'') && (line.empty() || !isIdentifierCharacter(line.back()))) {
+            // Literals are copied as they are, so the comment-like sequences within them are kept
+            line.push_back(character);
+            advance();
+            while(!atEnd() && current() != '\n') {
+                const auto literalCharacter = current();
+                line.push_back(literalCharacter);
+                advance();
+                if(literalCharacter == '\\' && !atEnd() && current() != '\n') {
+                    line.push_back(current());
+                    advance();
+                } else if(literalCharacter == character) {
+                    break;
+                }
+            }
+        } else {
+            line.push_back(character);
+            advance();
+        }
+    }
+
+    return line;
+}
+
+void tdw::IncludeScanner::scanDirective(std::vector<Include>& _includes) {
+    if(current() == '%') {
+        advance();
+    }
+    advance();
+    skipHorizontalSpace();
+
+    // The rest of the other directives is lexed as usual
+    const auto name = !atEnd() && isIdentifierStart(current()) ? readIdentifier() : std::string{};
+    if(macros) {
+        evaluateDirective(name);
+    }
+    if(name == "include" && !skipping()) {
+        scanInclude(_includes);
+    }
+}
+
+void tdw::IncludeScanner::scanInclude(std::vector<Include>& _includes) {
+    skipHorizontalSpace();
+    if(atEnd()) {
+        return;
+    }
+
+    char terminator;
+    Include::Type type;
+    if(current() == '"') {
+        terminator = '"';
+        type = Include::Type::q_char;
+    } else if(current() == '<') {
+        terminator = '>';
+        type = Include::Type::h_char;
+    } else if(macros) {
+        // `pp-tokens` form, the header name is the result of the macro expansion
+        const auto line = readLine();
+        const auto tokens = trim(line);
+        if(tokens.empty()) {
+            return;
+        }
+
+        const auto expansion = macros->expand(tokens);
+        if(expansion.size() > 2 && expansion.front() == '"' && expansion.back() == '"') {
+            _includes.emplace_back(expansion.substr(1, expansion.size() - 2), Include::Type::q_char);
+        } else if(expansion.size() > 2 && expansion.front() == '<' && expansion.back() == '>') {
+            _includes.emplace_back(expansion.substr(1, expansion.size() - 2), Include::Type::h_char);
+        } else {
+            // The tokens depend on the unknown macros, the include is reported as it's spelled
+            _includes.emplace_back(std::string{ tokens }, Include::Type::pp_tokens);
+        }
+        return;
+    } else {
+        // `pp-tokens` form requires macro expansion, which is only done when the macros are evaluated
+        return;
+    }
+    advance();
+
+    std::string headerName;
+    while(!atEnd() && current() != terminator && current() != '\n') {
+        headerName.push_back(current());
+        advance();
+    }
+
+    if(atEnd() || current() != terminator || headerName.empty()) {
+        // Ill-formed header name
+        return;
+    }
+    advance();
+
+    _includes.emplace_back(headerName, type);
+}
+
+void tdw::IncludeScanner::openConditional(std::optional<std::int64_t> _value) {
+    Conditional conditional{};
+    conditional.enclosingSkipped = skipping();
+    conditional.enclosingUncertain = uncertain();
+    if(conditional.enclosingSkipped) {
+        conditional.skipped = true;
+        // None of the groups is evaluated
+        conditional.taken = true;
+    } else if(_value && *_value) {
+        conditional.uncertain = conditional.enclosingUncertain;
+        conditional.taken = true;
+    } else if(_value) {
+        conditional.skipped = true;
+    } else {
+        conditional.uncertain = true;
+        conditional.maybeTaken = true;
+    }
+    conditionals.push_back(conditional);
+}
+
+template<typename Condition>
+void tdw::IncludeScanner::switchConditional(Condition _condition) {
+    auto& conditional = conditionals.back();
+    if(conditional.taken) {
+        conditional.skipped = true;
+        return;
+    }
+
+    const auto value = _condition();
+    if(value && !*value) {
+        conditional.skipped = true;
+    } else if(value) {
+        // The group is taken unless one of the previous ones was
+        conditional.skipped = false;
+        conditional.uncertain = conditional.enclosingUncertain || conditional.maybeTaken;
+        conditional.taken = true;
+    } else {
+        conditional.skipped = false;
+        conditional.uncertain = true;
+        conditional.maybeTaken = true;
+    }
+}
+
+void tdw::IncludeScanner::evaluateDirective(const std::string& _name) {
+    const auto outermost = conditionals.empty();
+
+    if(_name == "if" || _name == "ifdef" || _name == "ifndef") {
+        const auto expression = readLine();
+        std::optional<std::int64_t> value;
+        if(!skipping()) {
+            if(_name == "if") {
+                value = macros->evaluate(expression);
+            } else {
+                const auto macro = macros->find(leadingIdentifier(expression));
+                if(macro) {
+                    value = macro->defined == (_name == "ifdef");
+                }
+            }
+        }
+
+        if(outermost && guard == GuardState::none) {
+            guardMacro = _name == "ifndef" ? std::string{ leadingIdentifier(expression) } : _name == "if" ? guardCondition(expression) : std::string{};
+            guard = guardMacro.empty() ? GuardState::broken : GuardState::open;
+        } else if(outermost) {
+            guard = GuardState::broken;
+        }
+        openConditional(value);
+    } else if(_name == "elif" || _name == "elifdef" || _name == "elifndef" || _name == "else") {
+        const auto expression = readLine();
+        if(conditionals.empty()) {
+            return;
+        }
+        if(conditionals.size() == 1 && guard == GuardState::open) {
+            guard = GuardState::broken;
+        }
+
+        switchConditional([this, &_name, &expression]() -> std::optional<std::int64_t> {
+            if(_name == "else") {
+                return 1;
+            } else if(_name == "elif") {
+                return macros->evaluate(expression);
+            }
+            const auto macro = macros->find(leadingIdentifier(expression));
+            if(!macro) {
+                return std::nullopt;
+            }
+            return macro->defined == (_name == "elifdef");
+        });
+    } else if(_name == "endif") {
+        readLine();
+        if(conditionals.empty()) {
+            return;
+        }
+        conditionals.pop_back();
+        if(conditionals.empty() && guard == GuardState::open) {
+            guard = guardDefined ? GuardState::closed : GuardState::broken;
+        }
+    } else {
+        if(outermost && !_name.empty()) {
+            guard = GuardState::broken;
+        }
+        if(skipping()) {
+            return;
+        }
+
+        if(_name == "define" || _name == "undef") {
+            skipHorizontalSpace();
+            const auto name = !atEnd() && isIdentifierStart(current()) ? readIdentifier() : std::string{};
+            const auto functionLike = !atEnd() && current() == '(';
+            const auto line = readLine();
+            if(name.empty()) {
+                return;
+            }
+
+            if(uncertain()) {
+                // The group may be skipped, so the macro may or may not be changed
+                macros->forget(name);
+            } else if(_name == "undef") {
+                macros->undefine(name);
+            } else {
+                const auto parametersEnd = functionLike ? line.find(')') : std::string::npos;
+                const auto value = functionLike ? (parametersEnd == std::string::npos ? std::string_view{} : std::string_view{ line }.substr(parametersEnd + 1)) :
+                                                  std::string_view{ line };
+                macros->define(name, value, functionLike);
+            }
+            if(_name == "define" && conditionals.size() == 1 && guard == GuardState::open && name == guardMacro) {
+                guardDefined = true;
+            }
+        } else if(_name == "pragma") {
+            if(trim(readLine()) == "once") {
+                pragmaOnce = true;
+            }
+        }
+    }
+}
+#pragma endregion
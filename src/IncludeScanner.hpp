@@ -0,0 +1,154 @@
+#pragma once
+
+#include "Include.hpp"
+#include "MacroTable.hpp"
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tdw {
+
+    /**
+     * @brief Single pass lexer, which extracts `#include` directives from the source code.
+     * It follows the translation phases closely enough to tell directives from the noise: line splices (backslash-newline),
+     * line and block comments, ordinary, character and raw string literals are recognized and skipped, thus
+     * directives are only reported when they really start a line. The scan is linear in the size of the source.
+     * Optionally the scan stops at the first line of code, so only the leading preprocessor region of the file is read.
+     * Given the macros, the scan evaluates the conditional directives: the includes within the groups, which are known to be skipped,
+     * are ignored, the computed includes (`#include MACRO`) are expanded, and the include guards are recognized. Only the file's
+     * own macros and the given ones are known, the conditions depending on the rest are unknown and their groups are kept.
+    */
+    class IncludeScanner {
+    public:
+        using size_type = typename std::string_view::size_type;
+
+        /**
+         * @param _preambleOnly - stop at the first line which is neither a directive, nor a comment or whitespaces
+         * @param _macros - macros to evaluate the conditional directives with, they are not evaluated if null; must outlive the scanner
+        */
+        explicit IncludeScanner(std::string_view _source, bool _preambleOnly = false, const MacroTable* _macros = nullptr);
+
+        /**
+         * @return includes in the order they appear in the source
+        */
+        std::vector<Include> scan();
+
+        /**
+         * @return whether the scanned file is protected from being included twice by `#pragma once` or an include guard
+         * (only recognized when the conditional directives are evaluated)
+        */
+        bool guarded() const {
+            return pragmaOnce || guard == GuardState::closed;
+        }
+
+    private:
+        struct Conditional {
+            // The current group is known to be skipped (or the enclosing one is)
+            bool skipped;
+            // It's unknown whether the current group is skipped (or whether the enclosing one is)
+            bool uncertain;
+            // One of the groups is known to be taken, so the rest are skipped
+            bool taken;
+            // One of the groups may have been taken
+            bool maybeTaken;
+            bool enclosingSkipped;
+            bool enclosingUncertain;
+        };
+
+        enum class GuardState {
+            // Nothing but whitespaces and comments met yet
+            none,
+            // Within the `#ifndef GUARD` group
+            open,
+            // After the `#endif` of the guard group
+            closed,
+            // Something outside of the guard group
+            broken
+        };
+
+
+        /**
+         * @return position of the first character at or after `_position`, which doesn't start a line splice
+        */
+        size_type skipSplices(size_type _position) const;
+
+        bool atEnd() const {
+            return position >= source.size();
+        }
+
+        char current() const {
+            return source[position];
+        }
+
+        char lookahead() const {
+            const auto next = skipSplices(position + 1);
+            return next < source.size() ? source[next] : '\0';
+        }
+
+        void advance() {
+            position = skipSplices(position + 1);
+        }
+
+        void skipLineComment();
+        void skipBlockComment();
+        void skipQuoted(char _delimiter);
+        void skipRawString();
+        void skipNumber();
+        /**
+         * @brief Skips whitespaces and block comments within the current line
+        */
+        void skipHorizontalSpace();
+        /**
+         * @brief Reads an identifier, starting at the current character
+        */
+        std::string readIdentifier();
+        /**
+         * @brief Reads the rest of the line with the comments replaced by spaces; the new line character is left for the caller
+        */
+        std::string readLine();
+        /**
+         * @brief Reads the directive, the current character of which is `#` (or `%:`), and adds it to the `_includes` if it's an include
+        */
+        void scanDirective(std::vector<Include>& _includes);
+        /**
+         * @brief Reads the `#include` directive after its name
+        */
+        void scanInclude(std::vector<Include>& _includes);
+        /**
+         * @brief Evaluates the conditional or the macro directive (the name of which is already read) if the macros are evaluated
+        */
+        void evaluateDirective(const std::string& _name);
+
+        bool skipping() const {
+            return !conditionals.empty() && conditionals.back().skipped;
+        }
+
+        bool uncertain() const {
+            return !conditionals.empty() && conditionals.back().uncertain;
+        }
+
+        /**
+         * @brief Opens the conditional group of `#if`, `#ifdef` or `#ifndef` with the value of its condition
+        */
+        void openConditional(std::optional<std::int64_t> _value);
+        /**
+         * @brief Switches to the next group of the conditional (`#elif` and the like), the condition is evaluated only if needed
+        */
+        template<typename Condition>
+        void switchConditional(Condition _condition);
+
+        const std::string_view source;
+        const bool preambleOnly;
+        size_type position = 0;
+
+        // Given and the file's own macros, not evaluated if empty
+        std::optional<MacroTable> macros;
+        std::vector<Conditional> conditionals;
+        GuardState guard = GuardState::none;
+        std::string guardMacro;
+        bool guardDefined = false;
+        bool pragmaOnce = false;
+    };
+
+}
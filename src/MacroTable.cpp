@@ -0,0 +1,542 @@
+#include "MacroTable.hpp"
+#include <algorithm>
+#include <charconv>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+    using value_type = std::optional<std::int64_t>;
+
+    // Limits the nesting of the macro expansions and the parentheses, so a malicious source can't exhaust the stack
+    constexpr auto maxNesting = 256u;
+
+    inline bool isIdentifierStart(char _character) {
+        const auto character = static_cast<unsigned char>(_character);
+        return (character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z') || character == '_' || character >= 0x80;
+    }
+
+    inline bool isDigit(char _character) {
+        return _character >= '0' && _character <= '9';
+    }
+
+    inline bool isIdentifierCharacter(char _character) {
+        return isIdentifierStart(_character) || isDigit(_character);
+    }
+
+    inline bool isSpace(char _character) {
+        return _character == ' ' || _character == '\t' || _character == '\r' || _character == '\n' || _character == '\v' || _character == '\f';
+    }
+
+    bool isIdentifier(std::string_view _text) {
+        return !_text.empty() && isIdentifierStart(_text.front()) && std::all_of(_text.cbegin(), _text.cend(), isIdentifierCharacter);
+    }
+
+    std::string_view trim(std::string_view _text) {
+        while(!_text.empty() && isSpace(_text.front())) {
+            _text.remove_prefix(1);
+        }
+        while(!_text.empty() && isSpace(_text.back())) {
+            _text.remove_suffix(1);
+        }
+        return _text;
+    }
+
+    /**
+     * @return length of the literal starting at the beginning of the text (up to the end if it's unterminated)
+    */
+    std::size_t quotedLength(std::string_view _text) {
+        const auto delimiter = _text.front();
+        for(std::size_t i = 1; i < _text.size(); ++i) {
+            if(_text[i] == '\\') {
+                ++i;
+            } else if(_text[i] == delimiter) {
+                return i + 1;
+            }
+        }
+        return _text.size();
+    }
+
+    struct Token {
+        enum class Kind {
+            identifier,
+            number,
+            literal,
+            punctuator
+        };
+
+        Kind kind;
+        std::string_view text;
+    };
+
+    std::vector<Token> tokenize(std::string_view _text) {
+        constexpr std::string_view longPunctuators[] = { "&&", "||", "<<", ">>", "<=", ">=", "==", "!=" };
+
+        std::vector<Token> tokens;
+        std::size_t i = 0;
+        while(i < _text.size()) {
+            const auto character = _text[i];
+            auto length = static_cast<std::size_t>(1);
+            auto kind = Token::Kind::punctuator;
+            if(isSpace(character)) {
+                ++i;
+                continue;
+            } else if(isIdentifierStart(character)) {
+                while(i + length < _text.size() && isIdentifierCharacter(_text[i + length])) {
+                    ++length;
+                }
+                kind = Token::Kind::identifier;
+                if(i + length < _text.size() && (_text[i + length] == '\'' || _text[i + length] == '"')) {
+                    // Encoding prefix of a literal
+                    length += quotedLength(_text.substr(i + length));
+                    kind = Token::Kind::literal;
+                }
+            } else if(isDigit(character) || (character == '.' && i + 1 < _text.size() && isDigit(_text[i + 1]))) {
+                while(i + length < _text.size()) {
+                    const auto next = _text[i + length];
+                    const auto previous = _text[i + length - 1];
+                    if(isIdentifierCharacter(next) || next == '.' || next == '\'' ||
+                       ((next == '+' || next == '-') && (previous == 'e' || previous == 'E' || previous == 'p' || previous == 'P'))) {
+                        ++length;
+                    } else {
+                        break;
+                    }
+                }
+                kind = Token::Kind::number;
+            } else if(character == '\'' || character == '"') {
+                length = quotedLength(_text.substr(i));
+                kind = Token::Kind::literal;
+            } else {
+                for(const auto punctuator : longPunctuators) {
+                    if(_text.substr(i, punctuator.size()) == punctuator) {
+                        length = punctuator.size();
+                        break;
+                    }
+                }
+            }
+
+            tokens.push_back(Token{ kind, _text.substr(i, length) });
+            i += length;
+        }
+
+        return tokens;
+    }
+
+    value_type parseNumber(std::string_view _text) {
+        std::string digits;
+        for(const auto character : _text) {
+            if(character != '\'') {
+                digits.push_back(character);
+            }
+        }
+        while(!digits.empty() && (digits.back() == 'u' || digits.back() == 'U' || digits.back() == 'l' || digits.back() == 'L' ||
+                                  digits.back() == 'z' || digits.back() == 'Z')) {
+            digits.pop_back();
+        }
+
+        auto base = 10;
+        std::string_view number{ digits };
+        if(number.size() > 2 && number[0] == '0' && (number[1] == 'x' || number[1] == 'X')) {
+            base = 16;
+            number.remove_prefix(2);
+        } else if(number.size() > 2 && number[0] == '0' && (number[1] == 'b' || number[1] == 'B')) {
+            base = 2;
+            number.remove_prefix(2);
+        } else if(number.size() > 1 && number[0] == '0') {
+            base = 8;
+            number.remove_prefix(1);
+        }
+
+        std::uint64_t value = 0;
+        const auto [end, errorCode] = std::from_chars(number.data(), number.data() + number.size(), value, base);
+        if(errorCode != std::errc{} || end != number.data() + number.size()) {
+            // Floating point numbers are not allowed, user-defined literals are not supported
+            return std::nullopt;
+        }
+        return static_cast<std::int64_t>(value);
+    }
+
+    value_type parseCharacter(std::string_view _text) {
+        if(_text.size() == 3 && _text[0] == '\'' && _text[1] != '\\' && _text[2] == '\'') {
+            return static_cast<std::int64_t>(_text[1]);
+        }
+        // Escape sequences and multi-character literals are not supported
+        return std::nullopt;
+    }
+
+    /**
+     * @brief Replaces the macros within the controlling expression, evaluates the `defined` operators and parses the result.
+     * The operands are kept as optional values, the unknown ones are empty
+    */
+    class Evaluator {
+    public:
+        explicit Evaluator(const tdw::MacroTable& _macros) : macros{ _macros } {}
+
+        value_type evaluate(std::string_view _expression) {
+            expand(_expression, 0);
+            if(failed) {
+                return std::nullopt;
+            }
+
+            const auto value = conditional(0);
+            if(failed || index != terms.size()) {
+                return std::nullopt;
+            }
+            return value;
+        }
+
+    private:
+        struct Term {
+            // Operator or parenthesis, empty for the operands
+            std::string_view punctuator;
+            value_type value;
+        };
+
+        static bool isPunctuator(const Token& _token, std::string_view _text) {
+            return _token.kind == Token::Kind::punctuator && _token.text == _text;
+        }
+
+        /**
+         * @return position of the token after the parenthesized arguments starting at `_position`
+        */
+        static std::size_t skipArguments(const std::vector<Token>& _tokens, std::size_t _position) {
+            auto depth = 0u;
+            for(; _position < _tokens.size(); ++_position) {
+                if(isPunctuator(_tokens[_position], "(")) {
+                    ++depth;
+                } else if(isPunctuator(_tokens[_position], ")") && !--depth) {
+                    return _position + 1;
+                }
+            }
+            return _position;
+        }
+
+        void addValue(value_type _value) {
+            terms.push_back(Term{ std::string_view{}, _value });
+        }
+
+        void expand(std::string_view _text, unsigned _depth) {
+            if(_depth > maxNesting) {
+                failed = true;
+                return;
+            }
+
+            const auto tokens = tokenize(_text);
+            for(std::size_t i = 0; i < tokens.size(); ++i) {
+                const auto& token = tokens[i];
+                if(token.kind == Token::Kind::number) {
+                    addValue(parseNumber(token.text));
+                    continue;
+                } else if(token.kind == Token::Kind::literal) {
+                    addValue(parseCharacter(token.text));
+                    continue;
+                } else if(token.kind == Token::Kind::punctuator) {
+                    terms.push_back(Term{ token.text, std::nullopt });
+                    continue;
+                }
+
+                if(token.text == "defined") {
+                    const auto parenthesized = i + 1 < tokens.size() && isPunctuator(tokens[i + 1], "(");
+                    const auto operand = i + 1 + parenthesized;
+                    if(operand >= tokens.size() || tokens[operand].kind != Token::Kind::identifier ||
+                       (parenthesized && (operand + 1 >= tokens.size() || !isPunctuator(tokens[operand + 1], ")")))) {
+                        failed = true;
+                        return;
+                    }
+                    const auto macro = macros.find(tokens[operand].text);
+                    addValue(macro ? value_type{ macro->defined } : std::nullopt);
+                    i = operand + parenthesized;
+                    continue;
+                } else if(token.text == "true" || token.text == "false") {
+                    addValue(token.text == "true");
+                    continue;
+                }
+
+                const auto macro = macros.find(token.text);
+                const auto invoked = i + 1 < tokens.size() && isPunctuator(tokens[i + 1], "(");
+                if(invoked && (!macro || macro->functionLike)) {
+                    // Function-like macros (or `__has_include` and the like) are not expanded
+                    addValue(std::nullopt);
+                    i = skipArguments(tokens, i + 1) - 1;
+                } else if(!macro) {
+                    addValue(std::nullopt);
+                } else if(!macro->defined || macro->functionLike || std::find(active.cbegin(), active.cend(), token.text) != active.cend()) {
+                    // Identifiers, which are not replaced, evaluate to zero
+                    addValue(0);
+                } else {
+                    active.push_back(token.text);
+                    expand(macro->value, _depth + 1);
+                    active.pop_back();
+                    if(failed) {
+                        return;
+                    }
+                }
+            }
+        }
+
+        bool accept(std::string_view _punctuator) {
+            if(index < terms.size() && terms[index].punctuator == _punctuator) {
+                ++index;
+                return true;
+            }
+            return false;
+        }
+
+        static int precedence(std::string_view _operator) {
+            constexpr std::pair<std::string_view, int> precedences[] = {
+                { "||", 1 }, { "&&", 2 }, { "|", 3 }, { "^", 4 }, { "&", 5 }, { "==", 6 }, { "!=", 6 }, { "<", 7 }, { ">", 7 },
+                { "<=", 7 }, { ">=", 7 }, { "<<", 8 }, { ">>", 8 }, { "+", 9 }, { "-", 9 }, { "*", 10 }, { "/", 10 }, { "%", 10 }
+            };
+            for(const auto& [name, value] : precedences) {
+                if(name == _operator) {
+                    return value;
+                }
+            }
+            return 0;
+        }
+
+        static value_type apply(std::string_view _operator, value_type _left, value_type _right) {
+            if(_operator == "&&") {
+                if((_left && !*_left) || (_right && !*_right)) {
+                    return 0;
+                }
+                return _left && _right ? value_type{ 1 } : std::nullopt;
+            } else if(_operator == "||") {
+                if((_left && *_left) || (_right && *_right)) {
+                    return 1;
+                }
+                return _left && _right ? value_type{ 0 } : std::nullopt;
+            } else if(!_left || !_right) {
+                return std::nullopt;
+            }
+
+            const auto left = *_left;
+            const auto right = *_right;
+            // The unsigned arithmetic wraps around instead of overflowing
+            const auto unsignedLeft = static_cast<std::uint64_t>(left);
+            const auto unsignedRight = static_cast<std::uint64_t>(right);
+            if(_operator == "*") {
+                return static_cast<std::int64_t>(unsignedLeft * unsignedRight);
+            } else if(_operator == "/" || _operator == "%") {
+                if(!right || (left == std::numeric_limits<std::int64_t>::min() && right == -1)) {
+                    return std::nullopt;
+                }
+                return _operator == "/" ? left / right : left % right;
+            } else if(_operator == "+") {
+                return static_cast<std::int64_t>(unsignedLeft + unsignedRight);
+            } else if(_operator == "-") {
+                return static_cast<std::int64_t>(unsignedLeft - unsignedRight);
+            } else if(_operator == "<<" || _operator == ">>") {
+                if(right < 0 || right >= 64) {
+                    return std::nullopt;
+                }
+                return _operator == "<<" ? static_cast<std::int64_t>(unsignedLeft << right) : left >> right;
+            } else if(_operator == "<") {
+                return left < right;
+            } else if(_operator == ">") {
+                return left > right;
+            } else if(_operator == "<=") {
+                return left <= right;
+            } else if(_operator == ">=") {
+                return left >= right;
+            } else if(_operator == "==") {
+                return left == right;
+            } else if(_operator == "!=") {
+                return left != right;
+            } else if(_operator == "&") {
+                return left & right;
+            } else if(_operator == "^") {
+                return left ^ right;
+            }
+            return left | right;
+        }
+
+        value_type conditional(unsigned _depth) {
+            const auto condition = binary(1, _depth);
+            if(!accept("?")) {
+                return condition;
+            }
+
+            const auto whenTrue = conditional(_depth + 1);
+            if(!accept(":")) {
+                failed = true;
+                return std::nullopt;
+            }
+            const auto whenFalse = conditional(_depth + 1);
+            if(condition) {
+                return *condition ? whenTrue : whenFalse;
+            }
+            return whenTrue == whenFalse ? whenTrue : std::nullopt;
+        }
+
+        value_type binary(int _precedence, unsigned _depth) {
+            auto left = unary(_depth);
+            while(!failed && index < terms.size()) {
+                const auto operatorPrecedence = precedence(terms[index].punctuator);
+                if(!operatorPrecedence || operatorPrecedence < _precedence) {
+                    break;
+                }
+                const auto name = terms[index++].punctuator;
+                const auto right = binary(operatorPrecedence + 1, _depth);
+                left = apply(name, left, right);
+            }
+            return left;
+        }
+
+        value_type unary(unsigned _depth) {
+            if(_depth > maxNesting || index >= terms.size()) {
+                failed = true;
+                return std::nullopt;
+            }
+
+            const auto& term = terms[index++];
+            if(term.punctuator.empty()) {
+                return term.value;
+            } else if(term.punctuator == "(") {
+                const auto value = conditional(_depth + 1);
+                if(!accept(")")) {
+                    failed = true;
+                }
+                return value;
+            }
+
+            const auto operand = unary(_depth + 1);
+            if(!operand) {
+                return std::nullopt;
+            } else if(term.punctuator == "!") {
+                return !*operand;
+            } else if(term.punctuator == "~") {
+                return ~*operand;
+            } else if(term.punctuator == "-") {
+                return static_cast<std::int64_t>(0 - static_cast<std::uint64_t>(*operand));
+            } else if(term.punctuator == "+") {
+                return operand;
+            }
+            failed = true;
+            return std::nullopt;
+        }
+
+        const tdw::MacroTable& macros;
+        std::vector<Term> terms;
+        // Macros being expanded, they are not replaced again within their own replacement lists
+        std::vector<std::string_view> active;
+        std::size_t index = 0;
+        bool failed = false;
+    };
+
+    void expandText(const tdw::MacroTable& _macros, std::string_view _text, std::vector<std::string_view>& _active, std::string& _result) {
+        std::size_t i = 0;
+        while(i < _text.size()) {
+            const auto character = _text[i];
+            if(isSpace(character)) {
+                if(!_result.empty() && _result.back() != ' ') {
+                    _result.push_back(' ');
+                }
+                ++i;
+            } else if(character == '"' || character == '\'') {
+                const auto length = quotedLength(_text.substr(i));
+                _result.append(_text.substr(i, length));
+                i += length;
+            } else if(isIdentifierStart(character)) {
+                auto length = static_cast<std::size_t>(1);
+                while(i + length < _text.size() && isIdentifierCharacter(_text[i + length])) {
+                    ++length;
+                }
+                const auto identifier = _text.substr(i, length);
+                i += length;
+
+                const auto macro = _macros.find(identifier);
+                if(macro && macro->defined && !macro->functionLike && _active.size() < maxNesting &&
+                   std::find(_active.cbegin(), _active.cend(), identifier) == _active.cend()) {
+                    _active.push_back(identifier);
+                    expandText(_macros, macro->value, _active, _result);
+                    _active.pop_back();
+                } else {
+                    _result.append(identifier);
+                }
+            } else {
+                _result.push_back(character);
+                ++i;
+            }
+        }
+    }
+
+}
+
+#pragma region Actions
+void tdw::MacroTable::define(std::string_view _definition) {
+    const auto separator = _definition.find('=');
+    auto name = _definition.substr(0, separator);
+    const auto value = separator == std::string_view::npos ? std::string_view{ "1" } : _definition.substr(separator + 1);
+
+    const auto parameters = name.find('(');
+    const auto functionLike = parameters != std::string_view::npos;
+    if(functionLike) {
+        if(name.back() != ')') {
+            throw std::invalid_argument{ "Invalid macro definition: " + std::string{ _definition } };
+        }
+        name = name.substr(0, parameters);
+    }
+    if(!isIdentifier(name)) {
+        throw std::invalid_argument{ "Invalid macro definition: " + std::string{ _definition } };
+    }
+
+    define(name, value, functionLike);
+}
+
+void tdw::MacroTable::define(std::string_view _name, std::string_view _value, bool _functionLike) {
+    macros[std::string{ _name }] = Macro{ true, _functionLike, std::string{ trim(_value) } };
+}
+
+void tdw::MacroTable::undefine(std::string_view _name) {
+    macros[std::string{ _name }] = Macro{ false, false, std::string{} };
+}
+
+void tdw::MacroTable::forget(std::string_view _name) {
+    macros[std::string{ _name }] = std::nullopt;
+}
+#pragma endregion
+
+#pragma region Search
+const tdw::MacroTable::Macro* tdw::MacroTable::find(std::string_view _name) const {
+    if(!macros.empty()) {
+        const auto macro = macros.find(std::string{ _name });
+        if(macro != macros.cend()) {
+            return macro->second ? &*macro->second : nullptr;
+        }
+    }
+    return parent ? parent->find(_name) : nullptr;
+}
+
+std::optional<std::int64_t> tdw::MacroTable::evaluate(std::string_view _expression) const {
+    return Evaluator{ *this }.evaluate(_expression);
+}
+
+std::string tdw::MacroTable::expand(std::string_view _tokens) const {
+    std::string result;
+    std::vector<std::string_view> active;
+    expandText(*this, _tokens, active, result);
+    return std::string{ trim(result) };
+}
+
+std::string tdw::MacroTable::signature() const {
+    std::vector<std::string> lines;
+    for(const auto& [name, macro] : macros) {
+        if(!macro) {
+            lines.push_back("?" + name);
+        } else if(!macro->defined) {
+            lines.push_back("!" + name);
+        } else {
+            lines.push_back(name + (macro->functionLike ? "()=" : "=") + macro->value);
+        }
+    }
+    std::sort(lines.begin(), lines.end());
+
+    std::string signature;
+    for(const auto& line : lines) {
+        signature.append(line).push_back('\n');
+    }
+    return signature;
+}
+#pragma endregion
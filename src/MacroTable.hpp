@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace tdw {
+
+    /**
+     * @brief Table of the macros known while the conditional directives of a file are evaluated. Only the object-like macros are
+     * expanded, the function-like ones are only known to be defined. A macro may be unknown: neither defined, nor undefined by the
+     * command line or the file itself (or defined within a branch, which may not be taken), then the conditions depending on it are
+     * unknown as well. A table may extend another one (e.g. the file's own macros extend the command line ones) without copying it
+    */
+    class MacroTable {
+    public:
+        struct Macro {
+            bool defined;
+            bool functionLike;
+            // Replacement list of the macro
+            std::string value;
+        };
+
+        /**
+         * @param _parent - the table to look up the macros, which are not mentioned in this one, in; must outlive this one
+        */
+        explicit MacroTable(const MacroTable* _parent = nullptr) : parent{ _parent } {}
+
+        /**
+         * @brief Defines the macro given the way the compiler's `-D` option does: `NAME` (defined as `1`) or `NAME=VALUE`
+         * @throw `std::invalid_argument` if the name is not an identifier
+        */
+        void define(std::string_view _definition);
+        void define(std::string_view _name, std::string_view _value, bool _functionLike);
+        void undefine(std::string_view _name);
+        /**
+         * @brief Makes the macro unknown, even if the parent table knows it
+        */
+        void forget(std::string_view _name);
+
+        /**
+         * @return the macro or null if it's unknown
+        */
+        const Macro* find(std::string_view _name) const;
+
+        /**
+         * @brief Evaluates the controlling expression of `#if` or `#elif`. The logical operators and the conditional one are
+         * evaluated lazily, so the unknown operands don't matter, when the result doesn't depend on them
+         * @return the value or `std::nullopt` if it depends on the unknown macros (or can't be evaluated)
+        */
+        std::optional<std::int64_t> evaluate(std::string_view _expression) const;
+        /**
+         * @brief Replaces the object-like macros within the tokens (e.g. of a computed include) with their replacement lists.
+         * The rest of the identifiers are left as they are
+        */
+        std::string expand(std::string_view _tokens) const;
+
+        /**
+         * @return text describing all the macros of the table (without the parent's ones), the same for the same macros
+        */
+        std::string signature() const;
+
+    private:
+        const MacroTable* parent;
+        std::unordered_map<std::string, std::optional<Macro>> macros;
+    };
+
+}
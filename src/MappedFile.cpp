@@ -0,0 +1,85 @@
+#include "MappedFile.hpp"
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TDW_MAPPED_FILE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#pragma region Lifecycle
+tdw::MappedFile::MappedFile(const path_type& _path) {
+#ifdef TDW_MAPPED_FILE_MMAP
+    const auto descriptor = ::open(_path.c_str(), O_RDONLY);
+    if(descriptor < 0) {
+        throw std::runtime_error{ "Could not open the file: " + _path.string() };
+    }
+
+    struct stat status;
+    if(::fstat(descriptor, &status) != 0) {
+        ::close(descriptor);
+        throw std::runtime_error{ "Could not read the file: " + _path.string() };
+    }
+
+    size = static_cast<std::size_t>(status.st_size);
+    if(size) {
+        const auto address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if(address == MAP_FAILED) {
+            ::close(descriptor);
+            throw std::runtime_error{ "Could not map the file: " + _path.string() };
+        }
+        data = static_cast<const char*>(address);
+        mapped = true;
+    }
+    // The mapping stays valid after the descriptor is closed
+    ::close(descriptor);
+#else
+    std::ifstream ifs;
+    ifs.exceptions(ifs.exceptions() | std::ios::failbit);
+    ifs.open(_path, std::ios::binary);
+    using if_stream_buf_it = typename std::istreambuf_iterator<std::ifstream::char_type>;
+    buffer.assign(if_stream_buf_it{ ifs }, if_stream_buf_it{});
+    data = buffer.data();
+    size = buffer.size();
+#endif
+}
+
+tdw::MappedFile::~MappedFile() {
+    release();
+}
+
+tdw::MappedFile::MappedFile(MappedFile&& _other) noexcept {
+    *this = std::move(_other);
+}
+
+tdw::MappedFile& tdw::MappedFile::operator=(MappedFile&& _other) noexcept {
+    if(this != &_other) {
+        release();
+        buffer = std::move(_other.buffer);
+        data = _other.mapped ? _other.data : buffer.data();
+        size = _other.size;
+        mapped = _other.mapped;
+
+        _other.data = nullptr;
+        _other.size = 0;
+        _other.mapped = false;
+    }
+    return *this;
+}
+
+void tdw::MappedFile::release() {
+#ifdef TDW_MAPPED_FILE_MMAP
+    if(mapped) {
+        ::munmap(const_cast<char*>(data), size);
+    }
+#endif
+    data = nullptr;
+    size = 0;
+    mapped = false;
+    buffer.clear();
+}
+#pragma endregion
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+namespace tdw {
+
+    /**
+     * @brief Read-only view of the whole file content. On POSIX systems the file is memory-mapped, elsewhere it's read into a buffer
+    */
+    class MappedFile {
+    public:
+        using path_type = typename std::filesystem::path;
+
+        MappedFile() = default;
+        /**
+         * @throw `std::runtime_error` if the file cannot be opened or read
+        */
+        explicit MappedFile(const path_type& _path);
+        ~MappedFile();
+
+        MappedFile(MappedFile&& _other) noexcept;
+        MappedFile& operator=(MappedFile&& _other) noexcept;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        std::string_view view() const {
+            return std::string_view{ data, size };
+        }
+
+    private:
+        void release();
+
+        const char* data = nullptr;
+        std::size_t size = 0;
+        bool mapped = false;
+        // Used when the file is not mapped
+        std::vector<char> buffer;
+    };
+
+}
@@ -0,0 +1,96 @@
+#include "OutputWriter.hpp"
+#include <cerrno>
+#include <charconv>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TDW_OUTPUT_WRITER_DIRECT 1
+#include <unistd.h>
+#endif
+
+#pragma region Lifecycle
+tdw::OutputWriter::OutputWriter() : stream{ stdout }, ownsStream{ false } {
+    buffer.reserve(capacity);
+}
+
+tdw::OutputWriter::OutputWriter(const path_type& _filePath) : stream{ std::fopen(_filePath.c_str(), "wb") }, ownsStream{ true } {
+    if(!stream) {
+        throw std::runtime_error{ "Could not open the output file: " + _filePath.string() };
+    }
+    buffer.reserve(capacity);
+}
+
+tdw::OutputWriter::OutputWriter(std::string& _target) : target{ &_target } {
+    // The records end up in memory anyway, so the buffer is not reserved upfront
+}
+
+tdw::OutputWriter::~OutputWriter() {
+    try {
+        flush();
+    } catch(const std::runtime_error&) {
+        // Nowhere to report it
+    }
+
+    if(ownsStream) {
+        std::fclose(stream);
+    }
+}
+#pragma endregion
+
+#pragma region Static
+void tdw::OutputWriter::appendQuoted(std::string& _target, std::string_view _text) {
+    _target.push_back('"');
+    for(const auto character : _text) {
+        if(character == '"' || character == '\\') {
+            _target.push_back('\\');
+        }
+        _target.push_back(character);
+    }
+    _target.push_back('"');
+}
+#pragma endregion
+
+#pragma region Actions
+void tdw::OutputWriter::write(std::uint64_t _number) {
+    char digits[20];
+    const auto result = std::to_chars(std::begin(digits), std::end(digits), _number);
+    write(std::string_view{ digits, static_cast<std::size_t>(result.ptr - digits) });
+}
+
+void tdw::OutputWriter::writeQuoted(std::string_view _text) {
+    // Escaping may double the size at most, with the quotes on top
+    if(buffer.size() + 2 * _text.size() + 2 > capacity) {
+        flush();
+    }
+    appendQuoted(buffer, _text);
+}
+
+void tdw::OutputWriter::flush() {
+    if(target) {
+        target->append(buffer);
+        buffer.clear();
+        return;
+    }
+
+    auto failed = false;
+#ifdef TDW_OUTPUT_WRITER_DIRECT
+    const auto descriptor = ::fileno(stream);
+    for(std::size_t written = 0; written < buffer.size() && !failed;) {
+        const auto result = ::write(descriptor, buffer.data() + written, buffer.size() - written);
+        if(result >= 0) {
+            written += static_cast<std::size_t>(result);
+        } else {
+            failed = (errno != EINTR);
+        }
+    }
+#else
+    failed = std::fwrite(buffer.data(), 1, buffer.size(), stream) != buffer.size() || std::fflush(stream) != 0;
+#endif
+
+    // The content is dropped either way, so a failure is reported only once
+    buffer.clear();
+    if(failed) {
+        throw std::runtime_error{ "Could not write the output" };
+    }
+}
+#pragma endregion
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace tdw {
+
+    /**
+     * @brief Output sink which collects the records in a large reusable buffer and hands it to the file (or the standard output)
+     * only once the buffer is full or flushed explicitly. On POSIX systems the buffer is written directly to the file descriptor,
+     * bypassing the stream buffering. The records may be collected in a string as well
+    */
+    class OutputWriter {
+    public:
+        using path_type = typename std::filesystem::path;
+
+        /**
+         * @brief Writes to the standard output
+        */
+        OutputWriter();
+        /**
+         * @brief Writes to the given file, which is truncated
+         * @throw `std::runtime_error` if the file cannot be opened
+        */
+        explicit OutputWriter(const path_type& _filePath);
+        /**
+         * @brief Appends to the given string, which must outlive the writer
+        */
+        explicit OutputWriter(std::string& _target);
+        /**
+         * @brief Flushes the buffer, ignoring any failure. Call `flush` beforehand to get the failures reported
+        */
+        ~OutputWriter();
+
+        OutputWriter(const OutputWriter&) = delete;
+        OutputWriter& operator=(const OutputWriter&) = delete;
+
+        void write(std::string_view _text) {
+            if(buffer.size() + _text.size() > capacity) {
+                flush();
+            }
+            buffer.append(_text);
+        }
+
+        void write(char _character, std::size_t _count = 1) {
+            if(buffer.size() + _count > capacity) {
+                flush();
+            }
+            buffer.append(_count, _character);
+        }
+
+        void write(std::uint64_t _number);
+
+        /**
+         * @brief Appends the text within double quotes, escaping quotes and backslashes the same way `std::quoted` does (which is
+         * how `std::filesystem::path` is printed to a stream)
+        */
+        static void appendQuoted(std::string& _target, std::string_view _text);
+        /**
+         * @brief Writes the text quoted the same way `appendQuoted` does
+        */
+        void writeQuoted(std::string_view _text);
+
+        /**
+         * @brief Hands the buffered content to the file
+         * @throw `std::runtime_error` if the content cannot be written
+        */
+        void flush();
+
+    private:
+        static constexpr std::size_t capacity = 1 << 20;
+
+        std::FILE* stream = nullptr;
+        bool ownsStream = false;
+        std::string* target = nullptr;
+        std::string buffer;
+    };
+
+}
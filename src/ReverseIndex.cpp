@@ -0,0 +1,88 @@
+#include "ReverseIndex.hpp"
+#include <algorithm>
+#include <limits>
+
+#pragma region Lifecycle
+tdw::ReverseIndex::ReverseIndex(const IncludeGraph& _graph) : graph{ _graph }, offsets(static_cast<std::size_t>(_graph.size()) + 1) {
+    // A file including another one several times is its includer only once: the target was already met for the current
+    // source if its last source is the source id plus one
+    std::vector<node_id_type> lastSource(graph.size());
+    for(node_id_type node = 0; node < graph.size(); ++node) {
+        for(const auto& edge : graph.node(node).edges) {
+            if(lastSource[edge.target] != node + 1) {
+                lastSource[edge.target] = node + 1;
+                ++offsets[edge.target + 1];
+            }
+        }
+    }
+    for(std::size_t i = 1; i < offsets.size(); ++i) {
+        offsets[i] += offsets[i - 1];
+    }
+
+    sources.resize(offsets.back());
+    std::fill(lastSource.begin(), lastSource.end(), 0);
+    auto positions = offsets;
+    for(node_id_type node = 0; node < graph.size(); ++node) {
+        for(const auto& edge : graph.node(node).edges) {
+            if(lastSource[edge.target] != node + 1) {
+                lastSource[edge.target] = node + 1;
+                sources[positions[edge.target]++] = node;
+            }
+        }
+    }
+}
+
+tdw::ReverseIndex::Search::Search(const ReverseIndex& _index) : index{ _index }, marks(_index.graph.size()) {}
+#pragma endregion
+
+#pragma region Actions
+template<typename Neighbours>
+const std::vector<tdw::ReverseIndex::Reached>& tdw::ReverseIndex::Search::run(const std::vector<node_id_type>& _nodes, Neighbours&& _neighbours) {
+    if(queryNumber == std::numeric_limits<std::uint32_t>::max()) {
+        std::fill(marks.begin(), marks.end(), 0);
+        queryNumber = 0;
+    }
+    ++queryNumber;
+
+    reached.clear();
+    for(const auto node : _nodes) {
+        marks[node] = queryNumber;
+    }
+
+    // The result itself serves as the queue, the given nodes are expanded first, since they are not a part of it
+    std::size_t next = 0;
+    const auto visit = [this](unsigned _distance) {
+        return [this, _distance](node_id_type _neighbour) {
+            if(marks[_neighbour] != queryNumber) {
+                marks[_neighbour] = queryNumber;
+                reached.push_back(Reached{ _neighbour, _distance });
+            }
+        };
+    };
+    for(const auto node : _nodes) {
+        _neighbours(node, visit(1));
+    }
+    while(next < reached.size()) {
+        const auto [node, distance] = reached[next++];
+        _neighbours(node, visit(distance + 1));
+    }
+
+    return reached;
+}
+
+const std::vector<tdw::ReverseIndex::Reached>& tdw::ReverseIndex::Search::includers(const std::vector<node_id_type>& _nodes) {
+    return run(_nodes, [this](node_id_type _node, auto&& _visit) {
+        for(auto i = index.offsets[_node]; i < index.offsets[_node + 1]; ++i) {
+            _visit(index.sources[i]);
+        }
+    });
+}
+
+const std::vector<tdw::ReverseIndex::Reached>& tdw::ReverseIndex::Search::includes(const std::vector<node_id_type>& _nodes) {
+    return run(_nodes, [this](node_id_type _node, auto&& _visit) {
+        for(const auto& edge : index.graph.node(_node).edges) {
+            _visit(edge.target);
+        }
+    });
+}
+#pragma endregion
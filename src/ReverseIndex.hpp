@@ -0,0 +1,64 @@
+#pragma once
+
+#include "IncludeGraph.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace tdw {
+
+    /**
+     * @brief Answers reachability queries over the include graph in both directions: which files a file pulls in, and which files
+     * pull it in. The reverse adjacency (the files including each file, without repetitions) is built once in the compressed form,
+     * so each query is a breadth-first search over the integer node identifiers, linear in the size of the part of the graph it reaches.
+     * The index doesn't follow the changes of the graph, it has to be built again once the graph changes
+    */
+    class ReverseIndex {
+    public:
+        using node_id_type = typename IncludeGraph::node_id_type;
+
+        struct Reached {
+            node_id_type node;
+            // Number of includes in the shortest chain leading to the node
+            unsigned distance;
+        };
+
+        /**
+         * @brief Keeps the state of the queries, so they don't allocate memory for each of them. The index itself is never modified,
+         * thus any number of threads can query it at once, each with its own search
+        */
+        class Search {
+        public:
+            explicit Search(const ReverseIndex& _index);
+
+            /**
+             * @return the files including any of the given files directly or through other files, nearest first.
+             * The given files are not reported, even if they include each other. Stays valid until the next query
+            */
+            const std::vector<Reached>& includers(const std::vector<node_id_type>& _nodes);
+            /**
+             * @return the files included by any of the given files directly or through other files, nearest first.
+             * The given files are not reported, even if they include each other. Stays valid until the next query
+            */
+            const std::vector<Reached>& includes(const std::vector<node_id_type>& _nodes);
+
+        private:
+            template<typename Neighbours>
+            const std::vector<Reached>& run(const std::vector<node_id_type>& _nodes, Neighbours&& _neighbours);
+
+            const ReverseIndex& index;
+            // A node is visited by the current query if its mark equals the query number, so the marks are not cleared between queries
+            std::vector<std::uint32_t> marks;
+            std::uint32_t queryNumber = 0;
+            std::vector<Reached> reached;
+        };
+
+        explicit ReverseIndex(const IncludeGraph& _graph);
+
+    private:
+        const IncludeGraph& graph;
+        // Includers of the node `i` are `sources[offsets[i]]` to `sources[offsets[i + 1]]` (exclusive)
+        std::vector<std::size_t> offsets;
+        std::vector<node_id_type> sources;
+    };
+
+}
@@ -0,0 +1,209 @@
+#include "ScanCache.hpp"
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <system_error>
+
+namespace {
+
+    /**
+     * @brief Sequential reader of the mapped cache content. Once the reader runs out of data, it stays failed
+    */
+    class RecordReader {
+    public:
+        RecordReader(std::string_view _data, std::size_t _offset) : data{ _data }, offset{ _offset } {}
+
+        template<typename Integer>
+        Integer read() {
+            Integer value{};
+            if(!require(sizeof(Integer))) {
+                return value;
+            }
+            std::memcpy(&value, data.data() + offset, sizeof(Integer));
+            offset += sizeof(Integer);
+            return value;
+        }
+
+        std::string_view readString() {
+            const auto size = read<std::uint32_t>();
+            if(!require(size)) {
+                return std::string_view{};
+            }
+            const auto value = data.substr(offset, size);
+            offset += size;
+            return value;
+        }
+
+        bool failed() const {
+            return failure;
+        }
+
+        std::size_t position() const {
+            return offset;
+        }
+
+    private:
+        bool require(std::size_t _size) {
+            failure = failure || (data.size() - offset < _size);
+            return !failure;
+        }
+
+        const std::string_view data;
+        std::size_t offset;
+        bool failure = false;
+    };
+
+    template<typename Integer>
+    void write(std::ofstream& _ofs, Integer _value) {
+        _ofs.write(reinterpret_cast<const char*>(&_value), sizeof(Integer));
+    }
+
+    void writeString(std::ofstream& _ofs, const std::string& _value) {
+        write(_ofs, static_cast<std::uint32_t>(_value.size()));
+        _ofs.write(_value.data(), static_cast<std::streamsize>(_value.size()));
+    }
+
+}
+
+#pragma region Lifecycle
+tdw::ScanCache::ScanCache(const path_type& _cachePath, std::uint64_t _scanMode) : cachePath{ _cachePath }, scanMode{ _scanMode } {
+    std::error_code errorCode;
+    if(!std::filesystem::is_regular_file(cachePath, errorCode)) {
+        return;
+    }
+
+    try {
+        mapping = MappedFile{ cachePath };
+    } catch(const std::runtime_error&) {
+        // Unreadable cache doesn't prevent the analysis, it just gets rewritten
+        return;
+    }
+    loadIndex();
+}
+#pragma endregion
+
+#pragma region Static
+tdw::ScanCache::FileStamp tdw::ScanCache::stamp(const path_type& _filePath) {
+    using namespace std::filesystem;
+
+    return FileStamp{
+        static_cast<std::int64_t>(last_write_time(_filePath).time_since_epoch().count()),
+        static_cast<std::uint64_t>(file_size(_filePath))
+    };
+}
+
+std::uint64_t tdw::ScanCache::hash(std::string_view _data) {
+    // 64-bit FNV-1a
+    auto value = static_cast<std::uint64_t>(14695981039346656037ull);
+    for(const auto character : _data) {
+        value ^= static_cast<unsigned char>(character);
+        value *= static_cast<std::uint64_t>(1099511628211ull);
+    }
+    return value;
+}
+#pragma endregion
+
+#pragma region Actions
+std::optional<tdw::ScanCache::Record> tdw::ScanCache::find(const path_type& _filePath) const {
+    const auto it = index.find(_filePath.u8string());
+    if(it == index.cend()) {
+        return std::nullopt;
+    }
+
+    // Records were validated by `loadIndex`
+    RecordReader reader{ mapping.view(), it->second };
+    Record record;
+    record.stamp.modificationTime = reader.read<std::int64_t>();
+    record.stamp.size = reader.read<std::uint64_t>();
+    record.hash = reader.read<std::uint64_t>();
+    record.guarded = reader.read<std::uint8_t>() != 0;
+    const auto includesCount = reader.read<std::uint32_t>();
+    record.includes.reserve(includesCount);
+    for(auto i = static_cast<std::uint32_t>(0); i < includesCount; ++i) {
+        const auto type = static_cast<Include::Type>(reader.read<std::uint8_t>());
+        const auto spelling = reader.readString();
+        record.includes.emplace_back(std::filesystem::u8path(spelling.cbegin(), spelling.cend()), type);
+    }
+
+    return record;
+}
+
+void tdw::ScanCache::store(const path_type& _filePath, Record&& _record) {
+    std::lock_guard lock{ mutex };
+    records.insert_or_assign(_filePath.u8string(), std::move(_record));
+}
+
+void tdw::ScanCache::save() const {
+    // Unique name of the temporary file, so concurrent runs don't write into the same file
+    std::random_device randomDevice;
+    auto temporaryPath = cachePath;
+    temporaryPath += ".tmp" + std::to_string(randomDevice());
+
+    {
+        std::ofstream ofs;
+        ofs.exceptions(ofs.exceptions() | std::ios::failbit | std::ios::badbit);
+        ofs.open(temporaryPath, std::ios::binary | std::ios::trunc);
+
+        std::lock_guard lock{ mutex };
+        ofs.write(magic.data(), static_cast<std::streamsize>(magic.size()));
+        write(ofs, version);
+        write(ofs, scanMode);
+        write(ofs, static_cast<std::uint32_t>(records.size()));
+        for(const auto& [filePath, record] : records) {
+            writeString(ofs, filePath);
+            write(ofs, record.stamp.modificationTime);
+            write(ofs, record.stamp.size);
+            write(ofs, record.hash);
+            write(ofs, static_cast<std::uint8_t>(record.guarded));
+            write(ofs, static_cast<std::uint32_t>(record.includes.size()));
+            for(const auto& include : record.includes) {
+                write(ofs, static_cast<std::uint8_t>(include.type));
+                writeString(ofs, include.path.u8string());
+            }
+        }
+    }
+
+    std::error_code errorCode;
+    std::filesystem::rename(temporaryPath, cachePath, errorCode);
+    if(errorCode) {
+        std::filesystem::remove(temporaryPath, errorCode);
+        throw std::runtime_error{ "Could not write the cache file: " + cachePath.string() };
+    }
+}
+
+void tdw::ScanCache::loadIndex() {
+    const auto data = mapping.view();
+    if(data.substr(0, magic.size()) != magic) {
+        return;
+    }
+
+    RecordReader reader{ data, magic.size() };
+    if(reader.read<std::uint32_t>() != version || reader.read<std::uint64_t>() != scanMode) {
+        return;
+    }
+
+    const auto recordsCount = reader.read<std::uint32_t>();
+    std::unordered_map<std::string_view, std::size_t> recordsIndex;
+    auto validTypes = true;
+    for(auto i = static_cast<std::uint32_t>(0); i < recordsCount && !reader.failed(); ++i) {
+        const auto filePath = reader.readString();
+        const auto offset = reader.position();
+        reader.read<std::int64_t>();
+        reader.read<std::uint64_t>();
+        reader.read<std::uint64_t>();
+        reader.read<std::uint8_t>();
+        const auto includesCount = reader.read<std::uint32_t>();
+        for(auto j = static_cast<std::uint32_t>(0); j < includesCount && !reader.failed(); ++j) {
+            validTypes = validTypes && reader.read<std::uint8_t>() <= static_cast<std::uint8_t>(Include::Type::pp_tokens);
+            reader.readString();
+        }
+        recordsIndex.emplace(filePath, offset);
+    }
+
+    // Damaged caches are dropped as a whole
+    if(!reader.failed() && validTypes) {
+        index = std::move(recordsIndex);
+    }
+}
+#pragma endregion
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Include.hpp"
+#include "MappedFile.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace tdw {
+
+    /**
+     * @brief Persistent cache of the scanned includes, which lets re-runs skip the files that didn't change.
+     * Each record keeps the file's modification time, size and content hash along with the includes found in it. The cache
+     * file is memory-mapped and records are decoded only when they are looked up. The file is rewritten atomically and
+     * keeps only the records of the files met during the run.
+     * Lookups and stores are safe to perform from multiple threads.
+    */
+    class ScanCache {
+    public:
+        using path_type = typename std::filesystem::path;
+
+        struct FileStamp {
+            std::int64_t modificationTime = 0;
+            std::uint64_t size = 0;
+
+            bool operator==(const FileStamp& _other) const {
+                return modificationTime == _other.modificationTime && size == _other.size;
+            }
+        };
+
+        struct Record {
+            FileStamp stamp;
+            std::uint64_t hash = 0;
+            // The file is protected from being included twice (see `IncludeScanner::guarded`)
+            bool guarded = false;
+            std::vector<Include> includes;
+        };
+
+        /**
+         * @brief Loads the cache from the given file. A missing, outdated or damaged cache file is treated as empty, so is the
+         * one written for the other scan mode
+         * @param _scanMode - identifies the way the includes are scanned (e.g. the hash of the scanner options and macros),
+         * the includes found in the other modes differ
+        */
+        explicit ScanCache(const path_type& _cachePath, std::uint64_t _scanMode = 0);
+
+        static FileStamp stamp(const path_type& _filePath);
+        static std::uint64_t hash(std::string_view _data);
+
+        /**
+         * @return the record of the previous run for the file, if any
+        */
+        std::optional<Record> find(const path_type& _filePath) const;
+        /**
+         * @brief Keeps the record to be saved
+        */
+        void store(const path_type& _filePath, Record&& _record);
+        /**
+         * @brief Writes the records stored during the run to a temporary file, which then replaces the cache file
+        */
+        void save() const;
+
+    private:
+        static constexpr std::string_view magic{ "DINCSCAN" };
+        static constexpr std::uint32_t version = 3;
+
+        void loadIndex();
+
+        const path_type cachePath;
+        const std::uint64_t scanMode;
+        MappedFile mapping;
+        // Offsets of the records in the mapping (right past the path), keyed by the path
+        std::unordered_map<std::string_view, std::size_t> index;
+
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, Record> records;
+    };
+
+}
@@ -0,0 +1,403 @@
+#include "SocketServer.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TDW_SOCKET_SERVER_POSIX 1
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#ifdef TDW_SOCKET_SERVER_POSIX
+
+namespace {
+
+#ifdef MSG_NOSIGNAL
+    // A client, which went away, must not kill the server with `SIGPIPE`
+    constexpr auto sendFlags = MSG_NOSIGNAL;
+#else
+    constexpr auto sendFlags = 0;
+#endif
+
+    sockaddr_un socketAddress(const std::filesystem::path& _socketPath) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        const auto& path = _socketPath.native();
+        if(path.size() >= sizeof(address.sun_path)) {
+            throw std::runtime_error{ "The socket path is too long: " + _socketPath.string() };
+        }
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        return address;
+    }
+
+    /**
+     * @return connected socket descriptor or -1 if nothing listens on the socket
+    */
+    int connectSocket(const std::filesystem::path& _socketPath) {
+        const auto address = socketAddress(_socketPath);
+        const auto descriptor = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if(descriptor < 0) {
+            throw std::runtime_error{ "Could not create a socket" };
+        }
+        if(::connect(descriptor, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            ::close(descriptor);
+            return -1;
+        }
+        ::fcntl(descriptor, F_SETFD, FD_CLOEXEC);
+        return descriptor;
+    }
+
+    bool sendAll(int _descriptor, std::string_view _data) {
+        while(!_data.empty()) {
+            const auto result = ::send(_descriptor, _data.data(), _data.size(), sendFlags);
+            if(result < 0 && errno == EINTR) {
+                continue;
+            } else if(result < 0) {
+                return false;
+            }
+            _data.remove_prefix(static_cast<std::size_t>(result));
+        }
+        return true;
+    }
+
+    /**
+     * @brief Sends the data to the non-blocking socket until its buffer is full
+     * @return number of bytes sent or -1 if the connection failed
+    */
+    std::ptrdiff_t sendAvailable(int _descriptor, std::string_view _data) {
+        std::size_t sent = 0;
+        while(sent < _data.size()) {
+            const auto result = ::send(_descriptor, _data.data() + sent, _data.size() - sent, sendFlags);
+            if(result < 0 && errno == EINTR) {
+                continue;
+            } else if(result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            } else if(result < 0) {
+                return -1;
+            }
+            sent += static_cast<std::size_t>(result);
+        }
+        return static_cast<std::ptrdiff_t>(sent);
+    }
+
+    /**
+     * @return number of bytes received, 0 if the connection was closed or failed, -1 if nothing is available on the non-blocking socket
+    */
+    std::ptrdiff_t receive(int _descriptor, char* _buffer, std::size_t _size) {
+        while(true) {
+            const auto result = ::recv(_descriptor, _buffer, _size, 0);
+            if(result < 0 && errno == EINTR) {
+                continue;
+            } else if(result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return -1;
+            }
+            return result > 0 ? static_cast<std::ptrdiff_t>(result) : 0;
+        }
+    }
+
+}
+
+#pragma region Lifecycle
+tdw::SocketServer::SocketServer(const path_type& _socketPath) : socketPath{ _socketPath } {
+    const auto address = socketAddress(socketPath);
+
+    struct stat status;
+    if(::lstat(socketPath.c_str(), &status) == 0 && S_ISSOCK(status.st_mode)) {
+        const auto client = connectSocket(socketPath);
+        if(client >= 0) {
+            ::close(client);
+            throw std::runtime_error{ "Another server listens on the socket: " + socketPath.string() };
+        }
+        // Left by a server, which is not running anymore
+        ::unlink(socketPath.c_str());
+    }
+
+    descriptor = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if(descriptor < 0) {
+        throw std::runtime_error{ "Could not create a socket" };
+    }
+    ::fcntl(descriptor, F_SETFD, FD_CLOEXEC);
+    if(::bind(descriptor, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || ::listen(descriptor, SOMAXCONN) != 0) {
+        ::close(descriptor);
+        throw std::runtime_error{ "Could not listen on the socket: " + socketPath.string() };
+    }
+}
+
+tdw::SocketServer::~SocketServer() {
+    for(const auto& [client, state] : clients) {
+        ::close(client);
+    }
+    ::close(descriptor);
+    ::unlink(socketPath.c_str());
+}
+#pragma endregion
+
+#pragma region Static
+std::string tdw::SocketServer::request(const path_type& _socketPath, std::string_view _request) {
+    if(_request.find('\n') != std::string_view::npos) {
+        throw std::runtime_error{ "The request must be a single line" };
+    }
+
+    const auto descriptor = connectSocket(_socketPath);
+    if(descriptor < 0) {
+        throw std::runtime_error{ "Could not connect to the server: " + _socketPath.string() };
+    }
+
+    std::string response;
+    auto sent = sendAll(descriptor, _request) && sendAll(descriptor, "\n");
+    // The header line comes first, then the payload of the size given in it
+    std::size_t headerSize = std::string::npos;
+    std::size_t payloadSize = 0;
+    char buffer[64 * 1024];
+    while(sent) {
+        const auto count = receive(descriptor, buffer, sizeof(buffer));
+        if(count <= 0) {
+            break;
+        }
+        response.append(buffer, static_cast<std::size_t>(count));
+
+        if(headerSize == std::string::npos) {
+            const auto lineEnd = response.find('\n');
+            if(lineEnd == std::string::npos) {
+                continue;
+            }
+            headerSize = lineEnd + 1;
+            if(response.compare(0, 3, "ok ") != 0) {
+                break;
+            }
+            const auto result = std::from_chars(response.data() + 3, response.data() + lineEnd, payloadSize);
+            if(result.ec != std::errc{}) {
+                break;
+            }
+        }
+        if(response.size() >= headerSize + payloadSize) {
+            break;
+        }
+    }
+    ::close(descriptor);
+
+    if(headerSize == std::string::npos) {
+        throw std::runtime_error{ "The server closed the connection" };
+    } else if(response.compare(0, 6, "error ") == 0) {
+        throw std::runtime_error{ response.substr(6, headerSize - 7) };
+    } else if(response.compare(0, 3, "ok ") != 0 || response.size() < headerSize + payloadSize) {
+        throw std::runtime_error{ "Malformed response of the server" };
+    }
+    return response.substr(headerSize, payloadSize);
+}
+#pragma endregion
+
+#pragma region Actions
+std::vector<tdw::SocketServer::Request> tdw::SocketServer::wait(int _otherDescriptor, bool& _otherReady) {
+    std::vector<Request> requests;
+    std::vector<pollfd> descriptors;
+    char buffer[64 * 1024];
+    _otherReady = false;
+
+    while(requests.empty() && !_otherReady) {
+        descriptors.clear();
+        descriptors.push_back(pollfd{ descriptor, POLLIN, 0 });
+        descriptors.push_back(pollfd{ _otherDescriptor, POLLIN, 0 });
+        for(const auto& [client, state] : clients) {
+            // A client with the responses queued is not read from until it accepts them, so the responses don't pile up
+            descriptors.push_back(pollfd{ client, static_cast<short>(state.output.empty() ? POLLIN : POLLOUT), 0 });
+        }
+
+        if(::poll(descriptors.data(), static_cast<nfds_t>(descriptors.size()), -1) < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error{ "Could not wait for the requests" };
+        }
+
+        _otherReady = descriptors[1].revents != 0;
+        for(auto it = descriptors.cbegin() + 2; it != descriptors.cend(); ++it) {
+            if(!it->revents) {
+                continue;
+            } else if(it->events == POLLOUT) {
+                flush(it->fd);
+                continue;
+            }
+            const auto count = receive(it->fd, buffer, sizeof(buffer));
+            if(count < 0) {
+                continue;
+            } else if(!count) {
+                disconnect(it->fd);
+                continue;
+            }
+
+            auto& pending = clients[it->fd].input;
+            pending.append(buffer, static_cast<std::size_t>(count));
+            std::size_t lineStart = 0;
+            for(auto lineEnd = pending.find('\n'); lineEnd != std::string::npos; lineEnd = pending.find('\n', lineStart)) {
+                auto line = pending.substr(lineStart, lineEnd - lineStart);
+                if(!line.empty() && line.back() == '\r') {
+                    line.pop_back();
+                }
+                requests.push_back(Request{ it->fd, std::move(line) });
+                lineStart = lineEnd + 1;
+            }
+            pending.erase(0, lineStart);
+            if(pending.size() > maxRequestSize) {
+                // The descriptor may be reused by the connection accepted below, which must not get the responses
+                const auto client = it->fd;
+                requests.erase(std::remove_if(requests.begin(), requests.end(), [client](const Request& _request) {
+                    return _request.client == client;
+                }), requests.end());
+                disconnect(client);
+            }
+        }
+
+        if(descriptors[0].revents) {
+            const auto client = ::accept(descriptor, nullptr, nullptr);
+            if(client >= 0) {
+                ::fcntl(client, F_SETFD, FD_CLOEXEC);
+                ::fcntl(client, F_SETFL, ::fcntl(client, F_GETFL) | O_NONBLOCK);
+                clients.emplace(client, Client{});
+            }
+        }
+    }
+
+    return requests;
+}
+
+void tdw::SocketServer::reply(int _client, std::string_view _payload) {
+    char digits[20];
+    const auto result = std::to_chars(std::begin(digits), std::end(digits), _payload.size());
+    std::string header{ "ok " };
+    header.append(digits, result.ptr);
+    header.push_back('\n');
+    send(_client, header);
+    send(_client, _payload);
+}
+
+void tdw::SocketServer::replyError(int _client, std::string_view _message) {
+    std::string response{ "error " };
+    for(const auto character : _message) {
+        response.push_back(character == '\n' ? ' ' : character);
+    }
+    response.push_back('\n');
+    send(_client, response);
+}
+
+void tdw::SocketServer::drain() {
+    std::vector<pollfd> descriptors;
+    while(true) {
+        descriptors.clear();
+        for(const auto& [client, state] : clients) {
+            if(!state.output.empty()) {
+                descriptors.push_back(pollfd{ client, POLLOUT, 0 });
+            }
+        }
+        if(descriptors.empty()) {
+            return;
+        }
+
+        const auto ready = ::poll(descriptors.data(), static_cast<nfds_t>(descriptors.size()), static_cast<int>(drainTimeout.count()));
+        if(ready < 0 && errno == EINTR) {
+            continue;
+        } else if(ready <= 0) {
+            // None of the clients accepted anything in time
+            for(const auto& entry : descriptors) {
+                disconnect(entry.fd);
+            }
+            return;
+        }
+        for(const auto& entry : descriptors) {
+            if(entry.revents) {
+                flush(entry.fd);
+            }
+        }
+    }
+}
+
+void tdw::SocketServer::send(int _client, std::string_view _data) {
+    // The client may have gone away since the request was received
+    const auto client = clients.find(_client);
+    if(client == clients.end()) {
+        return;
+    }
+
+    auto& state = client->second;
+    if(state.output.empty()) {
+        const auto sent = sendAvailable(_client, _data);
+        if(sent < 0) {
+            disconnect(_client);
+            return;
+        }
+        _data.remove_prefix(static_cast<std::size_t>(sent));
+    }
+    state.output.append(_data);
+    if(state.output.size() - state.outputOffset > maxQueuedOutput) {
+        disconnect(_client);
+    }
+}
+
+void tdw::SocketServer::flush(int _client) {
+    const auto client = clients.find(_client);
+    if(client == clients.end()) {
+        return;
+    }
+
+    auto& state = client->second;
+    const auto sent = sendAvailable(_client, std::string_view{ state.output }.substr(state.outputOffset));
+    if(sent < 0) {
+        disconnect(_client);
+        return;
+    }
+    state.outputOffset += static_cast<std::size_t>(sent);
+    if(state.outputOffset == state.output.size()) {
+        state.output.clear();
+        state.outputOffset = 0;
+    }
+}
+
+void tdw::SocketServer::disconnect(int _client) {
+    if(clients.erase(_client)) {
+        ::close(_client);
+    }
+}
+#pragma endregion
+
+#else
+
+tdw::SocketServer::SocketServer(const path_type& _socketPath) : socketPath{ _socketPath } {
+    throw std::runtime_error{ "Serving the queries is only supported on POSIX systems" };
+}
+
+tdw::SocketServer::~SocketServer() = default;
+
+std::string tdw::SocketServer::request(const path_type&, std::string_view) {
+    throw std::runtime_error{ "Serving the queries is only supported on POSIX systems" };
+}
+
+std::vector<tdw::SocketServer::Request> tdw::SocketServer::wait(int, bool&) {
+    return std::vector<Request>{};
+}
+
+void tdw::SocketServer::reply(int, std::string_view) {
+}
+
+void tdw::SocketServer::replyError(int, std::string_view) {
+}
+
+void tdw::SocketServer::drain() {
+}
+
+void tdw::SocketServer::send(int, std::string_view) {
+}
+
+void tdw::SocketServer::flush(int) {
+}
+
+void tdw::SocketServer::disconnect(int) {
+}
+
+#endif
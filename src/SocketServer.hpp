@@ -0,0 +1,98 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace tdw {
+
+    /**
+     * @brief Line protocol server on a Unix domain socket. Each request is a single line, each response is either an `ok <size>`
+     * line followed by `size` bytes of the payload, or an `error <message>` line. A client may send any number of requests over
+     * a connection, they are answered in order. The connections are non-blocking: the responses a client doesn't accept right away
+     * are queued and sent as it reads them, so a slow client doesn't hold up the others. Only available on POSIX systems
+    */
+    class SocketServer {
+    public:
+        using path_type = typename std::filesystem::path;
+
+        struct Request {
+            // Connection to reply to
+            int client;
+            // The request line without the line break
+            std::string line;
+        };
+
+        /**
+         * @brief Starts listening on the socket. A socket file left by a server, which is not running anymore, is replaced
+         * @throw `std::runtime_error` if the socket cannot be created or another server listens on it
+        */
+        explicit SocketServer(const path_type& _socketPath);
+        /**
+         * @brief Closes the connections, dropping the responses not sent yet (see `drain`), and removes the socket file
+        */
+        ~SocketServer();
+
+        SocketServer(const SocketServer&) = delete;
+        SocketServer& operator=(const SocketServer&) = delete;
+
+        /**
+         * @brief Sends the request to the server listening on the socket and waits for the response
+         * @return payload of the response
+         * @throw `std::runtime_error` if the server cannot be reached or responds with an error
+        */
+        static std::string request(const path_type& _socketPath, std::string_view _request);
+
+        /**
+         * @brief Accepts the connections and reads them until some requests are complete, or the other descriptor
+         * (e.g. of a `Watcher`) becomes readable
+         * @param _otherReady - set to whether the other descriptor is readable
+         * @return the complete requests in the order they arrived
+        */
+        std::vector<Request> wait(int _otherDescriptor, bool& _otherReady);
+
+        void reply(int _client, std::string_view _payload);
+        /**
+         * @param _message - single line description of the failure
+        */
+        void replyError(int _client, std::string_view _message);
+        /**
+         * @brief Sends the queued responses until every client accepted them. A client, which accepts nothing for
+         * `drainTimeout`, is dropped
+        */
+        void drain();
+
+    private:
+        struct Client {
+            // Incomplete request line received from the connection
+            std::string input;
+            // Responses not sent yet, starting at the offset
+            std::string output;
+            std::size_t outputOffset = 0;
+        };
+
+        // Longer requests are not legitimate, the connection is dropped
+        static constexpr std::size_t maxRequestSize = 64 * 1024;
+        // The client, which doesn't read that many bytes of the responses, is dropped
+        static constexpr std::size_t maxQueuedOutput = std::size_t{ 1 } << 30;
+        static constexpr std::chrono::milliseconds drainTimeout{ 1000 };
+
+        /**
+         * @brief Sends the data right away as far as the client accepts it, the rest is queued
+        */
+        void send(int _client, std::string_view _data);
+        /**
+         * @brief Sends the queued responses as far as the client accepts them
+        */
+        void flush(int _client);
+        void disconnect(int _client);
+
+        const path_type socketPath;
+        int descriptor = -1;
+        std::unordered_map<int, Client> clients;
+    };
+
+}
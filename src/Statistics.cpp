@@ -0,0 +1,159 @@
+#include "Statistics.hpp"
+#include <algorithm>
+#include <ctime>
+#include <iterator>
+#include <iomanip>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TDW_STATISTICS_POSIX 1
+#include <sys/resource.h>
+#include <time.h>
+#endif
+
+namespace {
+
+    std::atomic<std::uint64_t> nextIdentifier{ 1 };
+
+    bool slowerFile(double _leftSeconds, double _rightSeconds) {
+        return _leftSeconds > _rightSeconds;
+    }
+
+}
+
+#pragma region Lifecycle
+tdw::Statistics::Timer::Timer(Statistics* _statistics, Phase _phase)
+    : statistics{ _statistics }, phase{ _phase }, wallStart{ std::chrono::steady_clock::now() }, cpuStart{ _statistics ? threadCpuTime() : std::chrono::nanoseconds{} } {}
+
+tdw::Statistics::Timer::~Timer() {
+    if(!statistics) {
+        return;
+    }
+
+    const auto wall = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - wallStart);
+    const auto cpu = threadCpuTime() - cpuStart;
+    auto& block = statistics->local();
+    block.wallNanoseconds[static_cast<std::size_t>(phase)].fetch_add(wall.count(), std::memory_order_relaxed);
+    block.cpuNanoseconds[static_cast<std::size_t>(phase)].fetch_add(cpu.count(), std::memory_order_relaxed);
+}
+
+tdw::Statistics::Statistics(std::size_t _slowestFilesCount) : identifier{ nextIdentifier++ }, slowestFilesCount{ _slowestFilesCount } {}
+#pragma endregion
+
+#pragma region Static
+std::size_t tdw::Statistics::peakMemory() {
+#ifdef TDW_STATISTICS_POSIX
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#endif
+#else
+    return 0;
+#endif
+}
+
+void tdw::Statistics::addParseTime(Statistics* _statistics, const std::string& _filePath, double _seconds) {
+    if(!_statistics || !_statistics->slowestFilesCount) {
+        return;
+    }
+
+    const auto fasterOnTop = [](const FileTime& _left, const FileTime& _right) {
+        return slowerFile(_left.seconds, _right.seconds);
+    };
+    auto& slowestFiles = _statistics->local().slowestFiles;
+    if(slowestFiles.size() < _statistics->slowestFilesCount) {
+        slowestFiles.push_back(FileTime{ _seconds, _filePath });
+        std::push_heap(slowestFiles.begin(), slowestFiles.end(), fasterOnTop);
+    } else if(slowerFile(_seconds, slowestFiles.front().seconds)) {
+        std::pop_heap(slowestFiles.begin(), slowestFiles.end(), fasterOnTop);
+        slowestFiles.back() = FileTime{ _seconds, _filePath };
+        std::push_heap(slowestFiles.begin(), slowestFiles.end(), fasterOnTop);
+    }
+}
+
+std::chrono::nanoseconds tdw::Statistics::threadCpuTime() {
+#ifdef TDW_STATISTICS_POSIX
+    timespec time{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return std::chrono::seconds{ time.tv_sec } + std::chrono::nanoseconds{ time.tv_nsec };
+#else
+    // The process time is the best approximation available
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(static_cast<double>(std::clock()) / CLOCKS_PER_SEC));
+#endif
+}
+#pragma endregion
+
+#pragma region Actions
+tdw::Statistics::ThreadBlock& tdw::Statistics::local() {
+    struct LocalBlock {
+        std::uint64_t owner = 0;
+        ThreadBlock* block = nullptr;
+    };
+    thread_local LocalBlock localBlock;
+
+    if(localBlock.owner != identifier) {
+        std::lock_guard lock{ mutex };
+        localBlock.block = blocks.emplace_back(std::make_unique<ThreadBlock>()).get();
+        localBlock.owner = identifier;
+    }
+    return *localBlock.block;
+}
+
+void tdw::Statistics::report(std::ostream& _ostr) const {
+    constexpr const char* phaseNames[] = { "walk", "build", "  read", "  scan", "  resolve", "  link", "output" };
+    constexpr const char* counterNames[] = {
+        "files parsed", "bytes read", "directives found", "scan cache hits", "resolver lookups", "resolver cache hits",
+        "resolver probes", "directory listings", "canonicalizations", "map operations"
+    };
+    static_assert(std::size(phaseNames) == static_cast<std::size_t>(Phase::size));
+    static_assert(std::size(counterNames) == static_cast<std::size_t>(Counter::size));
+
+    std::lock_guard lock{ mutex };
+    std::array<std::uint64_t, static_cast<std::size_t>(Counter::size)> counters{};
+    std::array<std::int64_t, static_cast<std::size_t>(Phase::size)> wallNanoseconds{};
+    std::array<std::int64_t, static_cast<std::size_t>(Phase::size)> cpuNanoseconds{};
+    std::vector<FileTime> slowestFiles;
+    for(const auto& block : blocks) {
+        for(std::size_t i = 0; i < counters.size(); ++i) {
+            counters[i] += block->counters[i].load(std::memory_order_relaxed);
+        }
+        for(std::size_t i = 0; i < wallNanoseconds.size(); ++i) {
+            wallNanoseconds[i] += block->wallNanoseconds[i].load(std::memory_order_relaxed);
+            cpuNanoseconds[i] += block->cpuNanoseconds[i].load(std::memory_order_relaxed);
+        }
+        slowestFiles.insert(slowestFiles.end(), block->slowestFiles.cbegin(), block->slowestFiles.cend());
+    }
+
+    const auto seconds = [](std::int64_t _nanoseconds) {
+        return static_cast<double>(_nanoseconds) / 1e9;
+    };
+    _ostr << std::fixed << std::setprecision(4);
+    _ostr << std::left << std::setw(20) << "phase" << std::right << std::setw(12) << "wall, s" << std::setw(12) << "CPU, s" << '\n';
+    for(std::size_t i = 0; i < wallNanoseconds.size(); ++i) {
+        _ostr << std::left << std::setw(20) << phaseNames[i] << std::right
+              << std::setw(12) << seconds(wallNanoseconds[i]) << std::setw(12) << seconds(cpuNanoseconds[i]) << '\n';
+    }
+    _ostr << "(the build sub-phases are summed over the threads)\n\n";
+
+    for(std::size_t i = 0; i < counters.size(); ++i) {
+        _ostr << std::left << std::setw(20) << counterNames[i] << std::right << std::setw(12) << counters[i] << '\n';
+    }
+    _ostr << std::left << std::setw(20) << "peak memory, MiB" << std::right << std::setw(12)
+          << static_cast<double>(peakMemory()) / (1024.0 * 1024.0) << '\n';
+
+    if(slowestFilesCount) {
+        std::sort(slowestFiles.begin(), slowestFiles.end(), [](const FileTime& _left, const FileTime& _right) {
+            return slowerFile(_left.seconds, _right.seconds);
+        });
+        slowestFiles.resize(std::min(slowestFiles.size(), slowestFilesCount));
+
+        _ostr << "\nslowest files to parse, ms\n";
+        for(const auto& file : slowestFiles) {
+            _ostr << std::setw(12) << file.seconds * 1000 << "  " << file.path << '\n';
+        }
+    }
+    _ostr << std::flush;
+}
+#pragma endregion
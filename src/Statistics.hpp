@@ -0,0 +1,122 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace tdw {
+
+    /**
+     * @brief Profiling counters and phase timers of a single run. Each thread updates its own block of counters (found through a
+     * thread-local pointer), so collecting them doesn't make the threads contend; the blocks are summed up only for the report.
+     * Everything is meant to be accessed through a nullable pointer, the profiling costs nothing when it's null
+    */
+    class Statistics {
+    public:
+        enum class Counter : std::size_t {
+            filesParsed,
+            bytesRead,
+            directivesFound,
+            scanCacheHits,
+            resolverLookups,
+            resolverCacheHits,
+            resolverProbes,
+            directoryListings,
+            canonicalizations,
+            mapOperations,
+            size
+        };
+
+        enum class Phase : std::size_t {
+            // Source directory walk
+            walk,
+            // The whole graph construction, the following four phases happen within it on multiple threads
+            build,
+            read,
+            scan,
+            resolve,
+            link,
+            // Counting the includes and writing the results
+            output,
+            size
+        };
+
+        /**
+         * @brief Measures the wall and the CPU time of the current thread spent from the construction to the destruction
+        */
+        class Timer {
+        public:
+            Timer(Statistics* _statistics, Phase _phase);
+            ~Timer();
+
+            Timer(const Timer&) = delete;
+            Timer& operator=(const Timer&) = delete;
+
+        private:
+            Statistics* statistics;
+            Phase phase;
+            std::chrono::steady_clock::time_point wallStart;
+            std::chrono::nanoseconds cpuStart;
+        };
+
+        /**
+         * @param _slowestFilesCount - number of the slowest files to parse to keep, none if zero
+        */
+        explicit Statistics(std::size_t _slowestFilesCount = 0);
+
+        Statistics(const Statistics&) = delete;
+        Statistics& operator=(const Statistics&) = delete;
+
+        /**
+         * @return peak resident set size of the process in bytes, or 0 if it's unknown
+        */
+        static std::size_t peakMemory();
+
+        static void add(Statistics* _statistics, Counter _counter, std::uint64_t _value = 1) {
+            if(_statistics) {
+                _statistics->local().counters[static_cast<std::size_t>(_counter)].fetch_add(_value, std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * @brief Considers the file for the list of the slowest files to parse
+        */
+        static void addParseTime(Statistics* _statistics, const std::string& _filePath, double _seconds);
+
+        /**
+         * @brief Writes the report. Must not run concurrently with the threads updating the statistics
+        */
+        void report(std::ostream& _ostr) const;
+
+    private:
+        struct FileTime {
+            double seconds;
+            std::string path;
+        };
+
+        struct ThreadBlock {
+            std::array<std::atomic<std::uint64_t>, static_cast<std::size_t>(Counter::size)> counters{};
+            std::array<std::atomic<std::int64_t>, static_cast<std::size_t>(Phase::size)> wallNanoseconds{};
+            std::array<std::atomic<std::int64_t>, static_cast<std::size_t>(Phase::size)> cpuNanoseconds{};
+            // Heap of the slowest files with the fastest on top, only touched by the owning thread
+            std::vector<FileTime> slowestFiles;
+        };
+
+        static std::chrono::nanoseconds threadCpuTime();
+
+        ThreadBlock& local();
+
+        // Tells the instances apart in the thread-local pointers, even if one is allocated at the address of another
+        const std::uint64_t identifier;
+        const std::size_t slowestFilesCount;
+        mutable std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadBlock>> blocks;
+    };
+
+}
@@ -0,0 +1,35 @@
+#include "StringPool.hpp"
+#include <algorithm>
+#include <iterator>
+
+#pragma region Actions
+tdw::StringPool::view_type tdw::StringPool::intern(view_type _string) {
+    // Needs no storage, while the last block may not exist yet
+    if(_string.empty()) {
+        return view_type{};
+    }
+
+    const auto it = strings.find(_string);
+    if(it != strings.cend()) {
+        return *it;
+    }
+
+    char_type* storage = nullptr;
+    if(_string.size() > blockSize / 4) {
+        // Put before the last block, so the rest of the last block is still used
+        auto block = std::make_unique<char_type[]>(_string.size());
+        storage = block.get();
+        blocks.insert(blocks.empty() ? blocks.end() : std::prev(blocks.end()), std::move(block));
+    } else {
+        if(blockUsed + _string.size() > blockSize) {
+            blocks.push_back(std::make_unique<char_type[]>(blockSize));
+            blockUsed = 0;
+        }
+        storage = blocks.back().get() + blockUsed;
+        blockUsed += _string.size();
+    }
+
+    std::copy(_string.cbegin(), _string.cend(), storage);
+    return *strings.insert(view_type{ storage, _string.size() }).first;
+}
+#pragma endregion
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace tdw {
+
+    /**
+     * @brief Interning arena of strings (include spellings and directories). Each distinct string is stored once, in large blocks
+     * allocated one after another, and is handed out as a view, which stays valid for the lifetime of the pool. Nothing is freed
+     * separately: the blocks are released at once along with the pool. The pool is not safe to use from multiple threads
+    */
+    class StringPool {
+    public:
+        using char_type = typename std::filesystem::path::value_type;
+        using view_type = typename std::basic_string_view<char_type>;
+
+        StringPool() = default;
+        StringPool(StringPool&&) = default;
+        StringPool& operator=(StringPool&&) = default;
+
+        StringPool(const StringPool&) = delete;
+        StringPool& operator=(const StringPool&) = delete;
+
+        /**
+         * @return view of the pooled copy of the string, the same one for the equal strings
+        */
+        view_type intern(view_type _string);
+
+        /**
+         * @return number of the distinct strings
+        */
+        std::size_t size() const {
+            return strings.size();
+        }
+
+    private:
+        // In characters. Strings longer than a quarter of it get a block of their own, so the blocks are not wasted on them
+        static constexpr std::size_t blockSize = 64 * 1024;
+
+        std::vector<std::unique_ptr<char_type[]>> blocks;
+        // Characters used in the last block
+        std::size_t blockUsed = blockSize;
+        std::unordered_set<view_type> strings;
+    };
+
+}
@@ -0,0 +1,144 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+
+namespace {
+
+    // Identifies the pool (and the queue within it) the current thread works for
+    thread_local const tdw::ThreadPool* currentPool = nullptr;
+    thread_local unsigned currentQueue = 0;
+
+}
+
+#pragma region Lifecycle
+tdw::ThreadPool::ThreadPool(unsigned _threadsCount) {
+    const auto threadsCount = std::max(_threadsCount, 1u);
+    for(auto i = 0u; i < threadsCount; ++i) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+
+    threads.reserve(threadsCount);
+    for(auto i = 0u; i < threadsCount; ++i) {
+        threads.emplace_back(&ThreadPool::work, this, i);
+    }
+}
+
+tdw::ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock{ stateMutex };
+        stopping = true;
+    }
+    tasksAvailable.notify_all();
+
+    for(auto& thread : threads) {
+        thread.join();
+    }
+}
+#pragma endregion
+
+#pragma region Actions
+void tdw::ThreadPool::submit(task_type _task) {
+    unsigned queueIndex;
+    if(currentPool == this) {
+        queueIndex = currentQueue;
+    } else {
+        std::lock_guard lock{ stateMutex };
+        queueIndex = nextQueue;
+        nextQueue = (nextQueue + 1) % static_cast<unsigned>(queues.size());
+    }
+
+    {
+        // Counted ahead, so the counters never go below the actual number of tasks
+        std::lock_guard lock{ stateMutex };
+        ++queuedTasks;
+        ++pendingTasks;
+    }
+
+    {
+        auto& queue = *queues[queueIndex];
+        std::lock_guard lock{ queue.mutex };
+        queue.tasks.push_back(std::move(_task));
+    }
+    tasksAvailable.notify_one();
+}
+
+void tdw::ThreadPool::wait() {
+    std::unique_lock lock{ stateMutex };
+    tasksDone.wait(lock, [this] { return pendingTasks == 0; });
+
+    if(error) {
+        auto exception = error;
+        error = nullptr;
+        std::rethrow_exception(exception);
+    }
+}
+#pragma endregion
+
+#pragma region Workers
+void tdw::ThreadPool::work(unsigned _index) {
+    currentPool = this;
+    currentQueue = _index;
+
+    while(true) {
+        {
+            std::unique_lock lock{ stateMutex };
+            tasksAvailable.wait(lock, [this] { return stopping || queuedTasks != 0; });
+            if(stopping) {
+                return;
+            }
+        }
+
+        task_type task;
+        if(!tryPop(_index, task)) {
+            // Another worker took the task first
+            continue;
+        }
+
+        bool discard;
+        {
+            std::lock_guard lock{ stateMutex };
+            --queuedTasks;
+            discard = static_cast<bool>(error);
+        }
+
+        if(!discard) {
+            try {
+                task();
+            } catch(...) {
+                std::lock_guard lock{ stateMutex };
+                if(!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+
+        std::lock_guard lock{ stateMutex };
+        if(--pendingTasks == 0) {
+            tasksDone.notify_all();
+        }
+    }
+}
+
+bool tdw::ThreadPool::tryPop(unsigned _index, task_type& _task) {
+    {
+        auto& queue = *queues[_index];
+        std::lock_guard lock{ queue.mutex };
+        if(!queue.tasks.empty()) {
+            _task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            return true;
+        }
+    }
+
+    for(auto offset = 1u; offset < queues.size(); ++offset) {
+        auto& queue = *queues[(_index + offset) % queues.size()];
+        std::lock_guard lock{ queue.mutex };
+        if(!queue.tasks.empty()) {
+            _task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+#pragma endregion
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tdw {
+
+    /**
+     * @brief Work-stealing thread pool. Each worker owns a queue: tasks submitted from within a worker go to the back of its own
+     * queue and are taken from there (LIFO, for the sake of locality), idle workers steal from the front of other queues.
+    */
+    class ThreadPool {
+    public:
+        using task_type = typename std::function<void()>;
+
+        explicit ThreadPool(unsigned _threadsCount);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /**
+         * @brief Schedules the task. Can be called from within the tasks of the pool
+        */
+        void submit(task_type _task);
+
+        /**
+         * @brief Blocks until all the submitted tasks (including those submitted by the tasks) are done.
+         * Rethrows the first exception thrown by a task, the tasks submitted after it are discarded
+        */
+        void wait();
+
+    private:
+        struct Queue {
+            std::mutex mutex;
+            std::deque<task_type> tasks;
+        };
+
+        void work(unsigned _index);
+        bool tryPop(unsigned _index, task_type& _task);
+
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::vector<std::thread> threads;
+
+        std::mutex stateMutex;
+        std::condition_variable tasksAvailable;
+        std::condition_variable tasksDone;
+        // Tasks in the queues
+        std::size_t queuedTasks = 0;
+        // Tasks in the queues along with the tasks being executed
+        std::size_t pendingTasks = 0;
+        unsigned nextQueue = 0;
+        bool stopping = false;
+        std::exception_ptr error;
+    };
+
+}
@@ -1,4 +1,5 @@
 #include "Utils.hpp"
+#include <algorithm>
 #include <filesystem>
 #include <unordered_set>
 #include <regex>
@@ -15,7 +16,10 @@ std::vector<tdw::utils::argument_type> tdw::utils::readArguments(int argc, char*
         auto found = false;
         for(const auto& option : optionsWhiteList) {
             // https://regex101.com/r/oMVOey/1: ^(-I|--include-directory)=?[^\S\r\n]*([\S]+)?
-            const auto optionPrefix = "^(-" + option.shortVersion + "|" + "--" + option.longVersion + ")=?";
+            // The long version must be followed by "=" or nothing, so options sharing a prefix are not confused
+            const auto longVersion = "--" + option.longVersion + "(?==|$)";
+            const auto optionNames = option.shortVersion.empty() ? longVersion : "-" + option.shortVersion + "|" + longVersion;
+            const auto optionPrefix = "^(" + optionNames + ")=?";
             const auto optionArgument = R"(\s*([\S]+)?)";
             
             if(option.acceptsArgument) {
@@ -28,10 +32,12 @@ std::vector<tdw::utils::argument_type> tdw::utils::readArguments(int argc, char*
                     const auto argument = argv[++i];
                     args.emplace_back(std::make_pair(option, argument));
                     found = true;
+                    break;
                 }
             } else if(std::regex_match(argv[i], std::regex{ optionPrefix })) {
                 args.emplace_back(std::make_pair(option, ""));
                 found = true;
+                break;
             }
            
         }
@@ -59,9 +65,74 @@ void tdw::utils::assertCompliantArguments(const std::vector<argument_type>& argu
             throw std::invalid_argument{ "Could not read the include path argument: \"" + std::get<std::string>(*it) + "\"" };
         }
         
-        const auto& path = std::get<option_type>(*it).second;
-        if(!std::filesystem::is_directory(path)) {
-            throw std::invalid_argument{ "Include option should refer to an existing directory: \"" + path + "\"" };
+        const auto& option = std::get<option_type>(*it);
+        if(std::operator==(option.first.shortVersion, "I")) {
+            const auto& path = option.second;
+            if(!std::filesystem::is_directory(path)) {
+                throw std::invalid_argument{ "Include option should refer to an existing directory: \"" + path + "\"" };
+            }
+        } else if(std::operator==(option.first.shortVersion, "j")) {
+            positiveNumberArgument(option);
         }
     }
 }
+
+unsigned tdw::utils::numberArgument(const option_type& _option) {
+    const auto& argument = _option.second;
+    if(argument.empty() || argument.find_first_not_of("0123456789") != std::string::npos || argument.size() > 9) {
+        throw std::invalid_argument{ "Option \"--" + _option.first.longVersion + "\" expects a number: \"" + argument + "\"" };
+    }
+
+    return static_cast<unsigned>(std::stoul(argument));
+}
+
+unsigned tdw::utils::positiveNumberArgument(const option_type& _option) {
+    const auto& argument = _option.second;
+    const auto invalidArgument = std::invalid_argument{ "Option \"--" + _option.first.longVersion + "\" expects a positive number: \"" + argument + "\"" };
+    if(argument.empty() || argument.find_first_not_of("0123456789") != std::string::npos || argument.size() > 9) {
+        throw invalidArgument;
+    }
+
+    const auto number = numberArgument(_option);
+    if(!number) {
+        throw invalidArgument;
+    }
+
+    return number;
+}
+
+bool tdw::utils::globMatch(std::string_view _pattern, std::string_view _text) {
+    // Backtracks to the last star only: any earlier star could only match less, which the last one makes up for
+    std::size_t patternIndex = 0;
+    std::size_t textIndex = 0;
+    auto starIndex = std::string_view::npos;
+    std::size_t starTextIndex = 0;
+    while(textIndex < _text.size()) {
+        if(patternIndex < _pattern.size() && _pattern[patternIndex] == '*') {
+            starIndex = patternIndex++;
+            starTextIndex = textIndex;
+        } else if(patternIndex < _pattern.size() && (_pattern[patternIndex] == '?' || _pattern[patternIndex] == _text[textIndex])) {
+            ++patternIndex;
+            ++textIndex;
+        } else if(starIndex != std::string_view::npos) {
+            patternIndex = starIndex + 1;
+            textIndex = ++starTextIndex;
+        } else {
+            return false;
+        }
+    }
+
+    while(patternIndex < _pattern.size() && _pattern[patternIndex] == '*') {
+        ++patternIndex;
+    }
+    return patternIndex == _pattern.size();
+}
+
+bool tdw::utils::isWithinDirectory(const std::filesystem::path& _path, const std::filesystem::path& _directory) {
+    auto directoryEnd = _directory.end();
+    // The trailing separator makes an empty last component
+    if(directoryEnd != _directory.begin() && std::prev(directoryEnd)->empty()) {
+        --directoryEnd;
+    }
+    return std::mismatch(_directory.begin(), directoryEnd, _path.begin(), _path.end()).first == directoryEnd;
+}
@@ -6,6 +6,7 @@
 #include <unordered_set>
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace tdw::utils {
@@ -49,6 +50,7 @@ namespace tdw::utils {
     }
 
     struct CommandLineOption {
+        // Empty, if the option has only the long version
         std::string shortVersion;
         std::string longVersion;
         bool acceptsArgument;
@@ -74,9 +76,52 @@ namespace tdw::utils {
     using argument_type = typename std::variant<option_type, std::string>;
     using argument_set_type = typename std::unordered_set<CommandLineOption, CommandLineOption::HashFunction, CommandLineOption::EqualTo>;
     std::vector<argument_type> readArguments(int argc, char* argv[], argument_set_type&& optionsWhiteList = argument_set_type{
-        { "I", "include-directory", true }
+        { "I", "include-directory", true },
+        { "j", "jobs", true },
+        { "o", "output", true },
+        { "", "cache", true },
+        { "", "watch", false },
+        { "", "counts-only", false },
+        { "", "format", true },
+        { "", "stats", false },
+        { "", "stats-top", true },
+        { "", "preamble-only", false },
+        { "", "who-includes", true },
+        { "", "impact", false },
+        { "", "serve", true },
+        { "", "compile-commands", true },
+        { "", "extensions", true },
+        { "", "ignore", true },
+        { "", "roots", true },
+        { "", "max-depth", true },
+        { "", "collapse-repeated", false },
+        { "D", "define", true },
+        { "U", "undefine", true },
+        { "", "preprocess", false }
     });
 
     void assertCompliantArguments(const std::vector<argument_type>& arguments);
 
+    /**
+     * @return non-negative number the argument of the option denotes
+    */
+    unsigned numberArgument(const option_type& _option);
+
+    /**
+     * @return positive number the argument of the option denotes
+    */
+    unsigned positiveNumberArgument(const option_type& _option);
+
+    /**
+     * @brief Matches the text against the shell-like glob: `*` matches any sequence of characters (slashes included), `?` - any
+     * single character, the rest of the characters match themselves
+    */
+    bool globMatch(std::string_view _pattern, std::string_view _text);
+
+    /**
+     * @return whether the path is the directory itself or lies within it. The paths are compared by whole components, so
+     * `/work/src2/file` is not within `/work/src`; both paths are expected to be normalized the same way (e.g. canonical)
+    */
+    bool isWithinDirectory(const std::filesystem::path& _path, const std::filesystem::path& _directory);
+
 }
@@ -0,0 +1,139 @@
+#include "Watcher.hpp"
+#include <stdexcept>
+#include <system_error>
+
+#ifdef __linux__
+#include <cerrno>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+
+#pragma region Lifecycle
+tdw::Watcher::Watcher() : descriptor{ ::inotify_init1(IN_CLOEXEC) } {
+    if(descriptor < 0) {
+        throw std::runtime_error{ "Could not start watching the files" };
+    }
+}
+
+tdw::Watcher::~Watcher() {
+    ::close(descriptor);
+}
+#pragma endregion
+
+#pragma region Actions
+void tdw::Watcher::addDirectory(const path_type& _path, bool _recursive) {
+    using namespace std::filesystem;
+
+    std::error_code errorCode;
+    const auto directoryPath = weakly_canonical(_path, errorCode);
+    if(errorCode || !is_directory(directoryPath, errorCode)) {
+        return;
+    }
+
+    if(watchedPaths.insert(directoryPath.native()).second) {
+        constexpr auto mask = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+        const auto watch = ::inotify_add_watch(descriptor, directoryPath.c_str(), mask);
+        if(watch < 0) {
+            watchedPaths.erase(directoryPath.native());
+            throw std::runtime_error{ "Could not watch the directory: " + directoryPath.string() };
+        }
+        watches[watch] = directoryPath;
+    }
+
+    if(!_recursive) {
+        return;
+    }
+
+    for(directory_iterator entries{ directoryPath, errorCode }, end; !errorCode && entries != end; entries.increment(errorCode)) {
+        std::error_code typeErrorCode;
+        if(entries->is_directory(typeErrorCode) && !entries->is_symlink(typeErrorCode)) {
+            addDirectory(entries->path(), true);
+        }
+    }
+}
+
+std::vector<tdw::Watcher::Event> tdw::Watcher::wait(std::chrono::milliseconds _settleTime) {
+    std::vector<Event> events;
+    readEvents(-1, events);
+    while(readEvents(static_cast<int>(_settleTime.count()), events)) {
+    }
+
+    return events;
+}
+
+bool tdw::Watcher::readEvents(int _timeout, std::vector<Event>& _events) {
+    pollfd request{ descriptor, POLLIN, 0 };
+    const auto ready = ::poll(&request, 1, _timeout);
+    if(ready < 0 && errno != EINTR) {
+        throw std::runtime_error{ "Could not wait for the file changes" };
+    }
+    if(ready <= 0) {
+        return false;
+    }
+
+    alignas(inotify_event) char buffer[64 * 1024];
+    const auto size = ::read(descriptor, buffer, sizeof(buffer));
+    if(size <= 0) {
+        return false;
+    }
+
+    for(auto offset = static_cast<decltype(size)>(0); offset < size;) {
+        const auto& event = *reinterpret_cast<const inotify_event*>(buffer + offset);
+        offset += static_cast<decltype(size)>(sizeof(inotify_event) + event.len);
+
+        if(event.mask & IN_Q_OVERFLOW) {
+            _events.push_back(Event{ path_type{}, Event::Type::overflow, false });
+            continue;
+        }
+
+        if(event.mask & IN_IGNORED) {
+            // The directory itself was removed
+            const auto watch = watches.find(event.wd);
+            if(watch != watches.cend()) {
+                watchedPaths.erase(watch->second.native());
+                watches.erase(watch);
+            }
+            continue;
+        }
+
+        const auto watch = watches.find(event.wd);
+        if(watch == watches.cend() || !event.len) {
+            continue;
+        }
+
+        auto type = Event::Type::modified;
+        if(event.mask & (IN_CREATE | IN_MOVED_TO)) {
+            type = Event::Type::created;
+        } else if(event.mask & (IN_DELETE | IN_MOVED_FROM)) {
+            type = Event::Type::removed;
+        }
+        _events.push_back(Event{ watch->second / event.name, type, (event.mask & IN_ISDIR) != 0 });
+    }
+
+    return true;
+}
+#pragma endregion
+
+#else
+
+tdw::Watcher::Watcher() {
+    throw std::runtime_error{ "Watching the files is only supported on Linux" };
+}
+
+tdw::Watcher::~Watcher() = default;
+
+void tdw::Watcher::addDirectory(const path_type&, bool) {
+}
+
+std::vector<tdw::Watcher::Event> tdw::Watcher::wait(std::chrono::milliseconds) {
+    return std::vector<Event>{};
+}
+
+bool tdw::Watcher::readEvents(int, std::vector<Event>&) {
+    return false;
+}
+
+#endif
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace tdw {
+
+    /**
+     * @brief Reports changes of the files within the watched directories. Backed by `inotify`, thus only available on Linux
+    */
+    class Watcher {
+    public:
+        using path_type = typename std::filesystem::path;
+
+        struct Event {
+            enum class Type {
+                // The file content was written
+                modified,
+                // The file or directory appeared (including being moved in)
+                created,
+                // The file or directory disappeared (including being moved out)
+                removed,
+                // Some events were lost, everything has to be considered changed
+                overflow
+            };
+
+            path_type path;
+            Type type;
+            bool directory;
+        };
+
+        /**
+         * @throw `std::runtime_error` if watching is not supported or the watcher cannot be created
+        */
+        Watcher();
+        ~Watcher();
+
+        Watcher(const Watcher&) = delete;
+        Watcher& operator=(const Watcher&) = delete;
+
+        /**
+         * @brief Starts watching the directory (and its sub-directories if requested). Directories already watched are ignored
+        */
+        void addDirectory(const path_type& _path, bool _recursive);
+
+        /**
+         * @brief Blocks until some changes happen. Once the first change arrives, waits for `_settleTime` to pass without
+         * changes, so a burst of changes (e.g. a file being saved) is reported at once
+        */
+        std::vector<Event> wait(std::chrono::milliseconds _settleTime);
+
+        /**
+         * @return descriptor, which becomes readable once some changes happen, so it can be waited for along with other descriptors
+        */
+        int nativeHandle() const {
+            return descriptor;
+        }
+
+    private:
+        /**
+         * @return `false` if no events arrived during the `_timeout`
+        */
+        bool readEvents(int _timeout, std::vector<Event>& _events);
+
+        int descriptor = -1;
+        std::unordered_map<int, path_type> watches;
+        std::unordered_set<path_type::string_type> watchedPaths;
+    };
+
+}
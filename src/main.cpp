@@ -1,23 +1,192 @@
 ﻿#include "Analyser.hpp"
+#include "SocketServer.hpp"
 #include "Utils.hpp"
 #include <iostream>
 #include <variant>
+#include <algorithm>
+#include <optional>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
 
 int main(int argc, char* argv[]) {
 	
 	try {
+		if (argc > 1 && std::string_view{ argv[1] } == "query") {
+			// Client of the server started with "--serve": dinclude query SOCKET REQUEST...
+			if (argc < 4) {
+				throw std::invalid_argument{ "Please specify a socket and a query" };
+			}
+			std::string request{ argv[3] };
+			for (auto i = 4; i < argc; ++i) {
+				// The server may run in another directory, so the paths which exist are passed as absolute
+				std::error_code errorCode;
+				const auto argumentPath = std::filesystem::path{ argv[i] };
+				request += ' ';
+				request += std::filesystem::exists(argumentPath, errorCode) ? std::filesystem::absolute(argumentPath).string() : argumentPath.string();
+			}
+			tdw::OutputWriter output;
+			output.write(tdw::SocketServer::request(argv[2], request));
+			output.flush();
+			return EXIT_SUCCESS;
+		}
+
 		const auto arguments = tdw::utils::readArguments(argc, argv);
 		tdw::utils::assertCompliantArguments(arguments);
 		
 		auto argIterator = arguments.cbegin();
-		const tdw::Analyser analyser{std::get<std::string>(*argIterator++)};
+		const auto sourcePath = std::get<std::string>(*argIterator++);
 
-		auto optionArguments = std::vector<tdw::Analyser::path_type>(arguments.size() - 1);
-		std::transform(argIterator, arguments.cend(), optionArguments.begin(), [](const tdw::utils::argument_type& arg) {
+		std::vector<tdw::Analyser::path_type> includePaths;
+		tdw::Analyser::BuildOptions buildOptions;
+		tdw::Analyser::SourceOptions sourceOptions;
+		tdw::Analyser::TreeOptions treeOptions;
+		bool treeLimited = false;
+		bool extensionsGiven = false;
+		std::optional<tdw::ScanCache::path_type> cachePath;
+		std::optional<tdw::OutputWriter::path_type> outputPath;
+		bool watch = false;
+		bool countsOnly = false;
+		std::optional<tdw::Analyser::path_type> queriedFile;
+		bool impact = false;
+		std::optional<tdw::Analyser::path_type> socketPath;
+		std::optional<tdw::CompilationDatabase::path_type> databasePath;
+		std::optional<tdw::GraphExporter::Format> format;
+		std::optional<tdw::MacroTable> macros;
+		bool collectStatistics = false;
+		std::size_t slowestFilesCount = 0;
+		std::for_each(argIterator, arguments.cend(), [&](const tdw::utils::argument_type& arg) {
 			const auto& optionArgument = std::get<tdw::utils::option_type>(arg);
-			return tdw::Analyser::path_type{ optionArgument.second };
+			if (optionArgument.first.shortVersion == "I") {
+				includePaths.emplace_back(optionArgument.second);
+			} else if (optionArgument.first.shortVersion == "j") {
+				buildOptions.jobs = tdw::utils::positiveNumberArgument(optionArgument);
+			} else if (optionArgument.first.longVersion == "cache") {
+				cachePath.emplace(optionArgument.second);
+			} else if (optionArgument.first.shortVersion == "o") {
+				outputPath.emplace(optionArgument.second);
+			} else if (optionArgument.first.longVersion == "watch") {
+				watch = true;
+			} else if (optionArgument.first.longVersion == "counts-only") {
+				countsOnly = true;
+			} else if (optionArgument.first.longVersion == "format") {
+				// The tree is the default format
+				format = optionArgument.second == "tree" ? std::nullopt : std::make_optional(tdw::GraphExporter::format(optionArgument.second));
+			} else if (optionArgument.first.longVersion == "stats") {
+				collectStatistics = true;
+			} else if (optionArgument.first.longVersion == "stats-top") {
+				collectStatistics = true;
+				slowestFilesCount = tdw::utils::positiveNumberArgument(optionArgument);
+			} else if (optionArgument.first.longVersion == "preamble-only") {
+				buildOptions.preambleOnly = true;
+			} else if (optionArgument.first.longVersion == "who-includes") {
+				queriedFile.emplace(optionArgument.second);
+			} else if (optionArgument.first.longVersion == "impact") {
+				impact = true;
+			} else if (optionArgument.first.longVersion == "serve") {
+				socketPath.emplace(optionArgument.second);
+			} else if (optionArgument.first.longVersion == "compile-commands") {
+				databasePath.emplace(optionArgument.second);
+			} else if (optionArgument.first.longVersion == "extensions") {
+				// The given extensions replace the default ones
+				if (!extensionsGiven) {
+					sourceOptions.filter.extensions.clear();
+					extensionsGiven = true;
+				}
+				std::string_view extensions{optionArgument.second};
+				while (!extensions.empty()) {
+					const auto extension = extensions.substr(0, extensions.find(','));
+					extensions.remove_prefix(std::min(extensions.size(), extension.size() + 1));
+					if (extension.empty() || extension == ".") {
+						throw std::invalid_argument{ "Option \"--extensions\" expects a comma-separated list: \"" + optionArgument.second + "\"" };
+					}
+					sourceOptions.filter.extensions.push_back(extension.front() == '.' ? std::string{extension} : "." + std::string{extension});
+				}
+			} else if (optionArgument.first.longVersion == "ignore") {
+				sourceOptions.filter.ignored.push_back(optionArgument.second);
+			} else if (optionArgument.first.longVersion == "roots") {
+				sourceOptions.filter.included.push_back(optionArgument.second);
+			} else if (optionArgument.first.longVersion == "max-depth") {
+				treeOptions.maxDepth = tdw::utils::numberArgument(optionArgument);
+				treeLimited = true;
+			} else if (optionArgument.first.longVersion == "collapse-repeated") {
+				treeOptions.collapseRepeated = true;
+				treeLimited = true;
+			} else if (optionArgument.first.shortVersion == "D" || optionArgument.first.shortVersion == "U" || optionArgument.first.longVersion == "preprocess") {
+				// Any of the definitions turns the evaluation of the conditional directives on, the later definitions win
+				if (!macros) {
+					macros.emplace();
+				}
+				if (optionArgument.first.shortVersion == "D") {
+					macros->define(optionArgument.second);
+				} else if (optionArgument.first.shortVersion == "U") {
+					macros->undefine(optionArgument.second);
+				}
+			}
 		});
-		analyser.printDependencyTree(optionArguments);
+		if (macros) {
+			buildOptions.macros = &*macros;
+		}
+		std::optional<tdw::ScanCache> cache;
+		if (cachePath) {
+			// The cached includes depend on the scan mode
+			std::string scanMode{ buildOptions.preambleOnly ? "preamble-only\n" : "" };
+			if (macros) {
+				scanMode += "preprocess\n" + macros->signature();
+			}
+			cache.emplace(*cachePath, tdw::ScanCache::hash(scanMode));
+			buildOptions.cache = &*cache;
+		}
+		std::optional<tdw::Statistics> statistics;
+		if (collectStatistics) {
+			statistics.emplace(slowestFilesCount);
+			buildOptions.statistics = &*statistics;
+		}
+
+		// The compilation database replaces the source directory walk
+		sourceOptions.jobs = buildOptions.jobs;
+		const auto analyser = databasePath
+			? tdw::Analyser{sourcePath, tdw::CompilationDatabase{*databasePath}, sourceOptions, buildOptions.statistics}
+			: tdw::Analyser{sourcePath, sourceOptions, buildOptions.statistics};
+
+		auto output = outputPath ? std::make_unique<tdw::OutputWriter>(*outputPath) : std::make_unique<tdw::OutputWriter>();
+		if (treeLimited && (format || countsOnly || queriedFile || impact)) {
+			throw std::invalid_argument{ "Options \"--max-depth\" and \"--collapse-repeated\" apply to the tree only" };
+		} else if (socketPath && (watch || format || countsOnly || queriedFile || impact || statistics)) {
+			throw std::invalid_argument{ "Option \"--serve\" cannot be combined with the output options" };
+		} else if (socketPath) {
+			analyser.serve(includePaths, buildOptions, treeOptions, *socketPath);
+		} else if ((queriedFile || impact) && (watch || format || countsOnly)) {
+			throw std::invalid_argument{ "Options \"--who-includes\" and \"--impact\" cannot be combined with the other output modes" };
+		} else if (queriedFile && impact) {
+			throw std::invalid_argument{ "Options \"--who-includes\" and \"--impact\" cannot be combined" };
+		} else if (queriedFile) {
+			analyser.printIncluders(includePaths, buildOptions, *queriedFile, *output);
+		} else if (impact) {
+			analyser.printImpact(includePaths, buildOptions, *output);
+		} else if (watch && (format || countsOnly)) {
+			throw std::invalid_argument{ "Option \"--watch\" supports only the tree format" };
+		} else if (watch && statistics) {
+			throw std::invalid_argument{ "Option \"--stats\" is not supported with \"--watch\"" };
+		} else if (watch) {
+			analyser.watch(includePaths, buildOptions, treeOptions, *output);
+		} else if (format) {
+			analyser.exportGraph(includePaths, buildOptions, *format, *output);
+		} else if (countsOnly) {
+			analyser.printIncludeCounters(includePaths, buildOptions, *output);
+		} else {
+			analyser.printDependencyTree(includePaths, buildOptions, treeOptions, *output);
+		}
+		{
+			const tdw::Statistics::Timer timer{buildOptions.statistics, tdw::Statistics::Phase::output};
+			output->flush();
+		}
+		if (cache) {
+			cache->save();
+		}
+		if (statistics) {
+			statistics->report(std::cerr);
+		}
 	} catch (const std::exception& exc) {
 		std::cerr << std::endl << exc.what() << std::endl;
 		return EXIT_FAILURE;
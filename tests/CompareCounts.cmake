@@ -0,0 +1,36 @@
+# Checks that "--counts-only" prints the same include counters as the tree does for the same sources
+# Usage: cmake -DDINCLUDE=<executable> -DSOURCE_DIR=<dir> "-DINCLUDE_DIRS=<dir;...>" -P CompareCounts.cmake
+
+foreach(INCLUDE_DIR ${INCLUDE_DIRS})
+    list(APPEND INCLUDE_ARGUMENTS -I ${INCLUDE_DIR})
+endforeach()
+
+function(run_dinclude OUTPUT_NAME)
+    execute_process(
+        COMMAND ${DINCLUDE} ${SOURCE_DIR} ${INCLUDE_ARGUMENTS} ${ARGN}
+        OUTPUT_VARIABLE OUTPUT
+        ERROR_VARIABLE ERRORS
+        RESULT_VARIABLE RESULT
+    )
+    if (NOT RESULT EQUAL 0)
+        message(FATAL_ERROR "dinclude ${ARGN} failed (${RESULT}): ${ERRORS}")
+    endif()
+    set(${OUTPUT_NAME} "${OUTPUT}" PARENT_SCOPE)
+endfunction()
+
+run_dinclude(TREE_OUTPUT)
+run_dinclude(COUNTS_OUTPUT --counts-only)
+
+# The counters follow the tree after an empty line
+string(FIND "${TREE_OUTPUT}" "\n\n" SUMMARY_START)
+if (SUMMARY_START EQUAL -1)
+    message(FATAL_ERROR "The tree output has no include counters:\n${TREE_OUTPUT}")
+endif()
+math(EXPR SUMMARY_START "${SUMMARY_START} + 2")
+string(SUBSTRING "${TREE_OUTPUT}" ${SUMMARY_START} -1 TREE_COUNTS)
+
+if (COUNTS_OUTPUT STREQUAL "")
+    message(FATAL_ERROR "--counts-only printed nothing")
+elseif (NOT TREE_COUNTS STREQUAL COUNTS_OUTPUT)
+    message(FATAL_ERROR "The counters differ.\nTree:\n${TREE_COUNTS}\n--counts-only:\n${COUNTS_OUTPUT}")
+endif()